@@ -0,0 +1,421 @@
+/**
+    @file bench.cpp
+    @brief benchmark della classe set templata
+
+    Uso: bench.exe [numero di elementi]
+**/
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include "set.hpp"
+#include "roaring_set.hpp"
+#include "string_set.hpp"
+#include "buffered_inserter.hpp"
+
+using std::cout;
+using std::endl;
+
+typedef std::chrono::steady_clock bench_clock;
+
+/**
+  @brief Funzione che ritorna i secondi trascorsi da un istante.
+*/
+double seconds_since(const bench_clock::time_point &start) {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/**
+  @brief Generatore pseudo casuale xorshift64, veloce e deterministico.
+*/
+struct xorshift {
+    unsigned long long state;
+
+    explicit xorshift(unsigned long long seed) : state(seed) {}
+
+    unsigned long long operator()() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+struct equal_int {
+    bool operator()(int a, int b) const {
+        return a == b;
+    }
+};
+
+struct hash_int {
+    std::size_t operator()(int a) const {
+        return static_cast<std::size_t>(a);
+    }
+};
+
+/**
+  @brief Benchmark contains casuali su un set con una politica di
+  allocazione. Il set è congelato, quindi la ricerca (Eytzinger) accede
+  all'array allocato da Storage e non all'indice.
+
+  @param name nome della politica
+  @param count numero di elementi del set
+  @param probes numero di ricerche casuali
+*/
+template <typename Storage>
+void bench_storage_probe(const char *name, std::size_t count, std::size_t probes) {
+    std::vector<int> values(count);
+    for (std::size_t i = 0; i < count; ++i)
+        values[i] = static_cast<int>(i);
+
+    set<int, equal_int, hash_int, unsigned int, Storage> probed(parallel_policy(), values.begin(), values.end());
+    probed.template freeze<std::less<int> >();
+
+    xorshift rng(42);
+    std::size_t found = 0;
+    const bench_clock::time_point start = bench_clock::now();
+    for (std::size_t i = 0; i < probes; ++i)
+        found += probed.contains(static_cast<int>(rng() % count));
+    const double elapsed = seconds_since(start);
+
+    cout << "set::contains " << name << " (" << count << " elementi, congelato): "
+         << probes / elapsed / 1e6 << " Mprobe/s [trovati " << found << "]" << endl;
+}
+
+/**
+  @brief Benchmark costruzione di un set con add, con una politica di
+  allocazione (misura il costo delle crescite dell'array).
+
+  @param name nome della politica
+  @param count numero di elementi aggiunti
+*/
+template <typename Storage>
+void bench_storage_add(const char *name, std::size_t count) {
+    const bench_clock::time_point start = bench_clock::now();
+    set<int, equal_int, hash_int, unsigned int, Storage> added;
+    for (std::size_t i = 0; i < count; ++i)
+        added.add(static_cast<int>(i));
+    const double elapsed = seconds_since(start);
+
+    cout << "set::add " << name << " (" << count << " elementi): "
+         << elapsed * 1000 << " ms, capacity " << added.capacity() << endl;
+}
+
+/**
+  @brief Benchmark di scalabilità della costruzione parallela del set.
+
+  @param count numero di elementi in input (circa metà duplicati)
+*/
+void bench_parallel_ctor(std::size_t count) {
+    std::vector<int> values(count);
+    xorshift rng(7);
+    for (std::size_t i = 0; i < count; ++i)
+        values[i] = static_cast<int>(rng() % (count / 2 + 1));
+
+    double single = 0;
+    for (unsigned threads = 1; threads <= std::thread::hardware_concurrency() * 2; threads *= 2) {
+        const bench_clock::time_point start = bench_clock::now();
+        const set<int, equal_int, hash_int> built(parallel_policy(threads), values.begin(), values.end());
+        const double elapsed = seconds_since(start);
+        if (threads == 1)
+            single = elapsed;
+
+        cout << "parallel ctor " << threads << " thread (" << count << " elementi, "
+             << built.size() << " unici): " << elapsed * 1000 << " ms, speedup "
+             << single / elapsed << endl;
+    }
+}
+
+struct equal_string {
+    bool operator()(const std::string &a, const std::string &b) const {
+        return a == b;
+    }
+};
+
+struct hash_string {
+    std::size_t operator()(const std::string &a) const {
+        return std::hash<std::string>()(a);
+    }
+};
+
+/**
+  @brief Benchmark della scrittura di un set su file, con l'operatore di
+  stream bufferizzato e con il ciclo originale su iostream.
+
+  @param name nome del tipo degli elementi
+  @param set set da scrivere
+*/
+template <typename Set>
+void bench_output(const char *name, const Set &set) {
+    std::ostringstream sizer;
+    sizer << set;
+    const double megabytes = sizer.str().size() / 1e6;
+
+    std::ofstream file("/dev/null");
+    bench_clock::time_point start = bench_clock::now();
+    file << set;
+    file.flush();
+    const double buffered = seconds_since(start);
+
+    start = bench_clock::now();
+    file << set.size();
+    for (auto curr = set.begin(); curr != set.end(); ++curr)
+        file << " (" << *curr << ")";
+    file.flush();
+    const double iostream = seconds_since(start);
+
+    cout << "output " << name << " (" << set.size() << " elementi, " << megabytes << " MB): buffered "
+         << megabytes / buffered << " MB/s, iostream " << megabytes / iostream << " MB/s" << endl;
+}
+
+/**
+  @brief Benchmark del roaring_set su id densi: memoria, contains,
+  unione e intersezione.
+
+  @param count numero di id
+*/
+void bench_roaring(std::size_t count) {
+    roaring_set<unsigned int> odd, thirds;
+    for (unsigned int i = 0; i < count; ++i) {
+        if (i % 2 == 1)
+            odd.add(i);
+        if (i % 3 == 0)
+            thirds.add(i);
+    }
+
+    xorshift rng(3);
+    std::size_t found = 0;
+    const std::size_t probes = 20000000;
+    bench_clock::time_point start = bench_clock::now();
+    for (std::size_t i = 0; i < probes; ++i)
+        found += odd.contains(static_cast<unsigned int>(rng() % count));
+    const double contains = seconds_since(start);
+
+    start = bench_clock::now();
+    const roaring_set<unsigned int> unionSet = odd + thirds;
+    const double unite = seconds_since(start);
+
+    start = bench_clock::now();
+    const roaring_set<unsigned int> intersectionSet = odd - thirds;
+    const double intersect = seconds_since(start);
+
+    cout << "roaring_set (" << odd.size() << " elementi): " << 8.0 * odd.bytes() / odd.size() << " bit/elemento, contains "
+         << probes / contains / 1e6 << " Mop/s [" << found % 10 << "], unione " << unite * 1000 << " ms ("
+         << unionSet.size() << "), intersezione " << intersect * 1000 << " ms (" << intersectionSet.size() << ")" << endl;
+}
+
+/**
+  @brief Benchmark del string_set rispetto al set di string con hash
+  (entrambi con l'indice adattivo) su URL: memoria e contains (metà delle
+  ricerche trovano la chiave).
+
+  @param count numero di URL
+*/
+void bench_string_set(std::size_t count) {
+    std::vector<std::string> urls(count);
+    xorshift rng(5);
+    for (std::size_t i = 0; i < count; ++i)
+        urls[i] = "https://example.com/item/" + std::to_string(rng() % 100000000) + "/" + std::to_string(i);
+
+    const set<std::string, equal_string, hash_string> stringSet(parallel_policy(), urls.begin(), urls.end());
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        bytes += urls[i].size();
+    string_set arenaSet;
+    arenaSet.reserve(static_cast<string_set::size_type>(count), bytes);
+    for (std::size_t i = 0; i < count; ++i)
+        arenaSet.add(urls[i]);
+
+    std::vector<std::string> probes(2000);
+    for (std::size_t i = 0; i < probes.size(); ++i)
+        probes[i] = i % 2 == 0 ? urls[rng() % count] : "https://example.com/item/missing/" + std::to_string(i);
+
+    std::size_t found = 0;
+    bench_clock::time_point start = bench_clock::now();
+    for (std::size_t i = 0; i < probes.size(); ++i)
+        found += stringSet.contains(probes[i]);
+    const double plain = seconds_since(start);
+
+    start = bench_clock::now();
+    for (std::size_t i = 0; i < probes.size(); ++i)
+        found += arenaSet.contains(probes[i]);
+    const double arena = seconds_since(start);
+
+    cout << "set<std::string> con indice -> string_set (" << count << " URL): memoria "
+         << stringSet.memory_usage(string_deep_size()).total() / 1e6 << " MB -> "
+         << arenaSet.memory_usage().total() / 1e6 << " MB, contains " << probes.size() / plain / 1e3
+         << " -> " << probes.size() / arena / 1e3 << " Kop/s [indice: " << stringSet.indexed()
+         << " -> " << arenaSet.indexed() << ", trovati " << found << "]" << endl;
+}
+
+/**
+  @brief Benchmark di add e contains al variare della size, con la sola
+  scansione lineare (null_hash) e con l'indice adattivo (hash_int).
+
+  @param size numero di elementi del set
+*/
+template <typename Set>
+double bench_add_contains(std::size_t size, std::size_t &found) {
+    const std::size_t probes = 1 << 20;
+    xorshift rng(9);
+    const bench_clock::time_point start = bench_clock::now();
+
+    Set s;
+    for (std::size_t i = 0; i < size; ++i)
+        s.add(static_cast<int>(i * 7));
+    for (std::size_t i = 0; i < probes; ++i)
+        found += s.contains(static_cast<int>(rng() % (size * 14)));
+
+    const double elapsed = seconds_since(start);
+    return (size + probes) / elapsed / 1e6;
+}
+
+void bench_adaptive(void) {
+    for (std::size_t size = 4; size <= 8192; size *= 4) {
+        std::size_t found = 0;
+        const double linear = bench_add_contains<set<int, equal_int> >(size, found);
+        const double adaptive = bench_add_contains<set<int, equal_int, hash_int> >(size, found);
+        cout << "add+contains (" << size << " elementi): lineare " << linear
+             << " Mop/s, adattivo " << adaptive << " Mop/s [" << found << "]" << endl;
+    }
+}
+
+/**
+  @brief Benchmark di contains su un set congelato (layout di Eytzinger)
+  rispetto alla scansione lineare, alla ricerca binaria su un array
+  ordinato e all'indice hash adattivo. Metà delle ricerche trovano la chiave.
+
+  @param max_size numero massimo di elementi
+*/
+void bench_freeze(std::size_t max_size) {
+    for (std::size_t size = 1000; size <= max_size; size *= 10) {
+        std::vector<int> values(size);
+        for (std::size_t i = 0; i < size; ++i)
+            values[i] = static_cast<int>(2 * i);
+        xorshift rng(13);
+        for (std::size_t i = size - 1; i > 0; --i)
+            std::swap(values[i], values[rng() % (i + 1)]);
+
+        const std::size_t probes = 2000000;
+        std::vector<int> keys(probes);
+        for (std::size_t i = 0; i < probes; ++i)
+            keys[i] = static_cast<int>(rng() % (2 * size));
+
+        set<int, equal_int, hash_int> s(parallel_policy(), values.begin(), values.end());
+        std::size_t found = 0;
+
+        const std::size_t linearProbes = std::min<std::size_t>(probes, std::max<std::size_t>(10, 200000000 / size));
+        bench_clock::time_point start = bench_clock::now();
+        for (std::size_t i = 0; i < linearProbes; ++i)
+            found += std::find(s.begin(), s.end(), keys[i]) != s.end();
+        const double linear = seconds_since(start) / linearProbes;
+
+        start = bench_clock::now();
+        for (std::size_t i = 0; i < probes; ++i)
+            found += s.contains(keys[i]);
+        const double hashed = seconds_since(start) / probes;
+
+        std::vector<int> sorted(values);
+        std::sort(sorted.begin(), sorted.end());
+        start = bench_clock::now();
+        for (std::size_t i = 0; i < probes; ++i)
+            found += std::binary_search(sorted.begin(), sorted.end(), keys[i]);
+        const double binary = seconds_since(start) / probes;
+        std::vector<int>().swap(sorted);
+
+        s.freeze();
+        start = bench_clock::now();
+        for (std::size_t i = 0; i < probes; ++i)
+            found += s.contains(keys[i]);
+        const double frozen = seconds_since(start) / probes;
+
+        cout << "contains (" << size << " elementi): lineare " << linear * 1e9 << " ns, binaria "
+             << binary * 1e9 << " ns, congelato " << frozen * 1e9 << " ns, hash " << hashed * 1e9
+             << " ns [" << found % 10 << "]" << endl;
+    }
+}
+
+/**
+  @brief Benchmark di inserimenti concorrenti con molti duplicati: add
+  diretta sul locked_set e add tramite buffered_inserter.
+
+  @param count numero di add per thread
+*/
+void bench_buffered_inserter(std::size_t count) {
+    const unsigned threads = 4;
+    for (int buffered = 0; buffered < 2; ++buffered) {
+        locked_set<int, equal_int, hash_int> shared;
+        std::vector<std::thread> workers;
+        const bench_clock::time_point start = bench_clock::now();
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.push_back(std::thread([&shared, count, t, buffered]() {
+                xorshift rng(t + 1);
+                buffered_inserter<int, equal_int, hash_int> inserter(shared);
+                for (std::size_t i = 0; i < count; ++i) {
+                    const int value = static_cast<int>((i / 16 * 31 + rng() % 4) % 65536);
+                    if (buffered)
+                        inserter.add(value);
+                    else
+                        shared.add(value);
+                }
+            }));
+        }
+        for (unsigned t = 0; t < threads; ++t)
+            workers[t].join();
+        const double elapsed = seconds_since(start);
+
+        cout << (buffered ? "buffered_inserter" : "locked_set::add") << " (" << threads << " thread, "
+             << count << " add/thread): " << threads * count / elapsed / 1e6 << " Madd/s, "
+             << shared.epoch() << " lock, " << shared.size() << " elementi" << endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (std::size_t(1) << 24);
+
+    cout << "!!!! STORAGE" << endl;
+    bench_storage_probe<heap_storage>("heap_storage", count, 20000000);
+    bench_storage_probe<huge_page_storage<> >("huge_page_storage", count, 20000000);
+    // heap_storage cresce di MAX_RESIZE elementi alla volta: O(N^2), solo su un set piccolo
+    bench_storage_add<heap_storage>("heap_storage", count / 64);
+    bench_storage_add<huge_page_storage<> >("huge_page_storage", count / 64);
+    bench_storage_add<huge_page_storage<> >("huge_page_storage", count);
+
+    cout << "!!!! PARALLEL CTOR" << endl;
+    bench_parallel_ctor(count);
+
+    cout << "!!!! OUTPUT" << endl;
+    std::vector<int> ints(count);
+    std::vector<std::string> strings(count / 4);
+    xorshift rng(11);
+    for (std::size_t i = 0; i < ints.size(); ++i)
+        ints[i] = static_cast<int>(rng());
+    for (std::size_t i = 0; i < strings.size(); ++i)
+        strings[i] = "https://example.com/item/" + std::to_string(rng() % 100000000);
+
+    bench_output("int", set<int, equal_int, hash_int>(parallel_policy(), ints.begin(), ints.end()));
+    bench_output("std::string", set<std::string, equal_string, hash_string>(parallel_policy(), strings.begin(), strings.end()));
+
+
+    cout << "!!!! ROARING" << endl;
+    bench_roaring(count);
+
+    cout << "!!!! STRING_SET" << endl;
+    bench_string_set(count / 256);
+
+    cout << "!!!! ADAPTIVE" << endl;
+    bench_adaptive();
+
+    cout << "!!!! FREEZE" << endl;
+    bench_freeze(count);
+
+    cout << "!!!! BUFFERED_INSERTER" << endl;
+    bench_buffered_inserter(count / 4);
+
+    return 0;
+}
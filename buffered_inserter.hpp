@@ -0,0 +1,285 @@
+/**
+  @file buffered_inserter.hpp
+
+  @brief File header delle classi locked_set e buffered_inserter template
+
+  File di dichiarazioni/definizioni della classe locked_set, un set condiviso
+  tra thread protetto da un mutex, e della classe buffered_inserter, che
+  raccoglie gli inserimenti di un thread e li scrive nel set condiviso a
+  blocchi
+*/
+
+#ifndef BUFFERED_INSERTER_HPP
+#define BUFFERED_INSERTER_HPP
+
+#include <atomic> // std::atomic
+#include <cassert> // assert
+#include <chrono> // std::chrono::steady_clock
+#include <mutex> // std::mutex, std::lock_guard
+#include "set.hpp"
+
+#define BUFFERED_INSERTER_BATCH 64
+
+/**
+  @brief classe set condiviso tra thread
+
+  La classe protegge un set con un mutex e conta le scritture con
+  un'epoca: ogni blocco di elementi aggiunto incrementa l'epoca dopo
+  essere stato applicato, quindi un lettore che osserva epoch() >= e
+  vede tutti i blocchi scritti fino all'epoca e.
+*/
+template <typename T, typename Equal, typename Hash = null_hash>
+class locked_set {
+public:
+    /**
+        TypeDef del tipo contenuto nel set e del set protetto
+    */
+    typedef T value_type;
+    typedef set<T, Equal, Hash> set_type;
+    typedef typename set_type::size_type size_type;
+private:
+    set_type _set;
+    mutable std::mutex _mutex;
+    std::atomic<unsigned long> _epoch;
+
+    locked_set(const locked_set &other); // non copiabile
+    locked_set& operator=(const locked_set &other);
+
+public:
+    /**
+        @brief Costruttore di default.
+
+        @post size() == 0
+        @post epoch() == 0
+    */
+    locked_set() : _epoch(0) {}
+
+    /**
+        @brief Funzione che aggiunge al set gli elementi di una sequenza
+        prendendo il lock una sola volta.
+
+        @param begin iteratore di inizio sequenza
+        @param end iteratore di fine sequenza
+
+        @return epoca dopo la scrittura
+
+        @throw std::bad_alloc possibile eccezione di allocazione (gli
+        elementi già aggiunti restano nel set e l'epoca viene incrementata)
+    */
+    template <typename Iter>
+    unsigned long add_all(Iter begin, Iter end) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        try {
+            for (; begin != end; ++begin)
+                _set.add(*begin);
+        } catch(...) {
+            _epoch.fetch_add(1, std::memory_order_release);
+            throw;
+        }
+        return _epoch.fetch_add(1, std::memory_order_release) + 1;
+    }
+
+    /**
+        @brief Funzione che aggiunge un elemento al set.
+
+        @param value reference costante dell'elemento da aggiungere
+
+        @return true se aggiunto con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool add(const value_type &value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const bool added = _set.add(value);
+        _epoch.fetch_add(1, std::memory_order_release);
+        return added;
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di un elemento.
+
+        @param value reference costante dell'elemento da controllare
+
+        @return true se l'elemento è presente nel set, false altrimenti
+    */
+    bool contains(const value_type &value) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _set.contains(value);
+    }
+
+    /**
+        @brief Funzione che ritorna il numero degli elementi del set.
+
+        @return numero degli elementi nel set
+    */
+    size_type size(void) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _set.size();
+    }
+
+    /**
+        @brief Funzione che ritorna il numero di blocchi scritti nel set.
+
+        @return epoca corrente
+    */
+    unsigned long epoch(void) const {
+        return _epoch.load(std::memory_order_acquire);
+    }
+
+    /**
+        @brief Funzione che ritorna una copia del set.
+
+        @return copia del set
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    set_type snapshot(void) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _set;
+    }
+};
+
+/**
+  @brief classe buffer di inserimento per un thread
+
+  La classe raccoglie gli elementi aggiunti da un thread in un piccolo set
+  locale (scansione lineare, o indice adattivo se il set ha un Hash), che
+  scarta i duplicati senza toccare il set condiviso, e li scrive nel
+  locked_set con un solo lock per blocco: quando il buffer contiene batch
+  elementi, quando il primo elemento in attesa è più vecchio di max_delay
+  o quando si chiama flush. max_delay viene controllato ad ogni add (anche
+  dei duplicati) e da flush_if_due: un thread che smette di aggiungere
+  deve chiamare flush_if_due (o flush) per rispettarlo. Gli elementi in
+  attesa non sono visibili agli altri thread fino al flush.
+
+  Ogni istanza va usata da un solo thread; il distruttore fa flush.
+*/
+template <typename T, typename Equal, typename Hash = null_hash>
+class buffered_inserter {
+public:
+    /**
+        TypeDef del tipo contenuto nel set e del set condiviso
+    */
+    typedef T value_type;
+    typedef locked_set<T, Equal, Hash> target_type;
+    typedef typename target_type::size_type size_type;
+    typedef std::chrono::steady_clock clock_type;
+private:
+    target_type &_target;
+    set<T, Equal, Hash> _buffer;
+    size_type _batch;
+    clock_type::duration _max_delay; // zero: nessun limite di tempo
+    clock_type::time_point _oldest; // istante del primo elemento in attesa
+    unsigned long _epoch; // epoca dell'ultimo flush
+
+    buffered_inserter(const buffered_inserter &other); // non copiabile
+    buffered_inserter& operator=(const buffered_inserter &other);
+
+    /**
+        @brief Funzione di supporto che controlla se il primo elemento in
+        attesa ha superato max_delay.
+
+        @return true se il buffer va scritto per il limite di tempo
+    */
+    bool due(void) const {
+        return _max_delay != clock_type::duration::zero() && _buffer.size() != 0 &&
+               clock_type::now() - _oldest >= _max_delay;
+    }
+
+public:
+    /**
+        @brief Costruttore che associa il buffer ad un set condiviso.
+
+        @param target set condiviso in cui scrivere
+        @param batch numero di elementi che fa scattare il flush
+        @param max_delay tempo massimo di attesa di un elemento, zero per
+        nessun limite
+
+        @pre batch > 0
+    */
+    explicit buffered_inserter(target_type &target, size_type batch = BUFFERED_INSERTER_BATCH,
+                               clock_type::duration max_delay = clock_type::duration::zero())
+        : _target(target), _buffer(batch), _batch(batch), _max_delay(max_delay), _epoch(0) {
+        assert(batch > 0);
+    }
+
+    /**
+        @brief Distruttore, scrive gli elementi in attesa. Eventuali errori
+        vengono ignorati: per vederli chiamare flush prima della distruzione.
+    */
+    ~buffered_inserter() {
+        try {
+            flush();
+        } catch(...) {
+        }
+    }
+
+    /**
+        @brief Funzione che aggiunge un elemento al buffer.
+
+        @param value reference costante dell'elemento da aggiungere
+
+        @return true se l'elemento non era già in attesa nel buffer
+        (può comunque essere già presente nel set condiviso)
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool add(const value_type &value) {
+        const bool added = _buffer.add(value);
+        if (added && _buffer.size() == 1 && _max_delay != clock_type::duration::zero())
+            _oldest = clock_type::now();
+
+        if (_buffer.size() >= _batch || due())
+            flush();
+        return added;
+    }
+
+    /**
+        @brief Funzione che scrive gli elementi in attesa se il primo è più
+        vecchio di max_delay. Va chiamata periodicamente dai thread che
+        possono smettere di aggiungere elementi.
+
+        @return true se il buffer è stato scritto, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool flush_if_due(void) {
+        if (!due())
+            return false;
+        flush();
+        return true;
+    }
+
+    /**
+        @brief Funzione che scrive nel set condiviso gli elementi in attesa.
+
+        @return epoca del set condiviso dopo la scrittura (l'epoca
+        dell'ultima scrittura se non c'era niente da scrivere)
+
+        @throw std::bad_alloc possibile eccezione di allocazione (il
+        buffer viene svuotato comunque)
+    */
+    unsigned long flush(void) {
+        if (_buffer.size() != 0) {
+            try {
+                _epoch = _target.add_all(_buffer.begin(), _buffer.end());
+            } catch(...) {
+                _buffer.erase_all();
+                throw;
+            }
+            _buffer.erase_all();
+        }
+        return _epoch;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero di elementi in attesa.
+
+        @return numero di elementi nel buffer
+    */
+    size_type pending(void) const {
+        return _buffer.size();
+    }
+};
+
+#endif // BUFFERED_INSERTER_HPP
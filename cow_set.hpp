@@ -0,0 +1,325 @@
+/**
+  @file cow_set.hpp
+
+  @brief File header della classe cow_set templata
+
+  File di dichiarazioni/definizioni della classe cow_set, un set con
+  memoria condivisa copy-on-write
+*/
+
+#ifndef COW_SET_HPP
+#define COW_SET_HPP
+
+#include <atomic> // std::atomic
+#include <cassert> // assert
+#include <future> // std::future, std::async
+#include <iostream> // std::ostream
+#include <string> // std::string
+#include "set.hpp"
+
+/**
+  @brief classe set copy-on-write
+
+  La classe espone la stessa interfaccia di set ma le copie condividono
+  lo stesso set tramite un contatore di riferimenti atomico: copiare costa
+  O(1) e il set viene duplicato solo alla prima add/remove che lo modifica
+  davvero mentre è condiviso. Istanze diverse possono essere usate da thread
+  diversi, la stessa istanza no.
+*/
+template <typename T, typename Equal, typename Hash = null_hash>
+class cow_set {
+public:
+    /**
+        TypeDef del tipo contenuto nel set e del set condiviso
+    */
+    typedef T value_type;
+    typedef set<T, Equal, Hash> set_type;
+    typedef typename set_type::size_type size_type;
+
+    /**
+        TypeDef dell'iteratore Costante
+    */
+    typedef typename set_type::const_iterator const_iterator;
+private:
+    /**
+        Blocco condiviso tra le copie: contatore di riferimenti e set
+    */
+    struct shared_data {
+        std::atomic<unsigned long> refs;
+        set_type data;
+
+        shared_data() : refs(1) {}
+
+        explicit shared_data(const set_type &other) : refs(1), data(other) {}
+    };
+
+    shared_data* _shared; // nullptr se il set è vuoto e mai modificato
+
+    /**
+        @brief Funzione di supporto che rilascia il blocco condiviso,
+        deallocandolo se era l'ultimo riferimento.
+
+        @post _shared == nullptr
+    */
+    void release(void) {
+        if (_shared != nullptr && _shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete _shared;
+        _shared = nullptr;
+    }
+
+    /**
+        @brief Funzione di supporto che rende il blocco condiviso
+        esclusivo dell'istanza corrente copiandolo se necessario.
+
+        @return reference al set esclusivo
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    set_type& detach(void) {
+        if (_shared == nullptr) {
+            _shared = new shared_data();
+        } else if (_shared->refs.load(std::memory_order_acquire) != 1) {
+            shared_data* tmp = new shared_data(_shared->data);
+            release();
+            _shared = tmp;
+        }
+        return _shared->data;
+    }
+
+public:
+    /**
+        @brief Costruttore di default.
+
+        @post size() == 0
+    */
+    cow_set() : _shared(nullptr) {}
+
+    /**
+        @brief Costruttore che copia un set.
+
+        @param other set da copiare
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    explicit cow_set(const set_type &other) : _shared(new shared_data(other)) {}
+
+    /**
+        @brief Copy constructor, condivide il set in O(1).
+
+        @param other set da condividere
+    */
+    cow_set(const cow_set &other) : _shared(other._shared) {
+        if (_shared != nullptr)
+            _shared->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+        @brief Operatore di assegnamento, condivide il set in O(1).
+
+        @param other set da condividere
+
+        @return reference al set this
+    */
+    cow_set& operator=(const cow_set &other) {
+        if (this != &other) {
+            cow_set tmp(other);
+            this->swap(tmp);
+        }
+
+        return *this;
+    }
+
+    /**
+        @brief Distruttore, rilascia il set condiviso.
+    */
+    ~cow_set() {
+        release();
+    }
+
+    /**
+        @brief Funzione che svuota il set.
+
+        @post size() == 0
+    */
+    void clear(void) {
+        release();
+    }
+
+    /**
+        @brief Funzione scambia lo stato tra l'istanza corrente
+        e quella passata come parametro.
+
+        @param other set con cui scambiare lo stato
+    */
+    void swap(cow_set &other) {
+        std::swap(_shared, other._shared);
+    }
+
+    /**
+        @brief Funzione che ritorna il set sottostante (sola lettura).
+
+        @return reference costante al set
+    */
+    const set_type& get(void) const {
+        static const set_type empty;
+        return _shared == nullptr ? empty : _shared->data;
+    }
+
+    /**
+        @brief Funzione che ritorna se il set è condiviso con altre copie.
+
+        @return true se il set è condiviso, false altrimenti
+    */
+    bool shared(void) const {
+        return _shared != nullptr && _shared->refs.load(std::memory_order_acquire) != 1;
+    }
+
+    /**
+        @brief Funzione che ritorna quanti elementi può contenere il set.
+
+        @return numero che rappresenta la capacità del set
+    */
+    size_type capacity(void) const {
+        return get().capacity();
+    }
+
+    /**
+        @brief Funzione che ritorna il numero degli elementi del set.
+
+        @return numero degli elementi nel set
+    */
+    size_type size(void) const {
+        return get().size();
+    }
+
+    /**
+        @brief Funzione che ritorna il digest del set (vedi set::digest).
+
+        @return digest del set
+    */
+    std::size_t digest(void) const {
+        return get().digest();
+    }
+
+    /**
+        @brief Operatore getter di una cella dell'array del set.
+
+        @param index della cella da leggere
+        @return reference costante all'elemento da leggere
+
+        @pre index < size()
+    */
+    const value_type& operator[](const size_type index) const {
+        return get()[index];
+    }
+
+    /**
+        @brief Funzione che aggiunge un elemento al set, copiando il set
+        se è condiviso e l'elemento non è già presente.
+
+        @param value reference costante dell'elemento da aggiungere
+
+        @return true se aggiunto con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool add(const value_type &value) {
+        if (contains(value))
+            return false;
+        return detach().add(value);
+    }
+
+    /**
+        @brief Funzione che rimuove un elemento dal set, copiando il set
+        se è condiviso e l'elemento è presente.
+
+        @param value reference costante dell'elemento da rimuovere
+
+        @return true se rimosso con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool remove(const value_type &value) {
+        if (!contains(value))
+            return false;
+        return detach().remove(value);
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di un elemento.
+
+        @param value reference costante dell'elemento da controllare
+
+        @return true se l'elemento è presente nel set, false altrimenti
+    */
+    bool contains(const value_type &value) const {
+        return _shared != nullptr && _shared->data.contains(value);
+    }
+
+    /**
+        @brief Funzione che controlla se due set sono uguali, in O(1)
+        se condividono lo stesso set.
+
+        @param other reference costante del set da controllare
+
+        @return true se i set contengolo gli stessi elementi, false altrimenti
+    */
+    bool operator==(const cow_set &other) const {
+        return _shared == other._shared || get() == other.get();
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore all'inizio della sequenza dati.
+
+        @return iteratore all'inizio della sequenza dati
+    */
+    const_iterator begin(void) const {
+        return get().begin();
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore alla fine della sequenza dati.
+
+        @return iteratore alla fine della sequenza dati
+    */
+    const_iterator end(void) const {
+        return get().end();
+    }
+
+    /**
+        @brief Funzione GLOBALE che implementa l'operatore di stream.
+
+        @param os stream di output
+        @param ol set da spedire sullo stream
+
+        @return lo stream di output
+    */
+    friend std::ostream& operator<<(std::ostream &os, const cow_set &ol) {
+        return os << ol.get();
+    }
+};
+
+/**
+    @brief Funzione GLOBALE che salva il cow_set di tipo string su file in
+    background (vedi save_async del set). L'istantanea costa O(1): il thread
+    di scrittura condivide il set e il chiamante lo copia solo alla prima
+    modifica.
+
+    @param set set da scrivere su un file
+    @param file file su cui scrivere
+
+    @return future che diventa pronto a scrittura completata e
+    rilancia le eventuali eccezioni della scrittura
+
+    @throw std::system_error se non è possibile creare il thread
+*/
+template<typename Equal, typename Hash>
+[[nodiscard]] std::future<void> save_async(const cow_set<std::string, Equal, Hash> &set, const std::string &file) {
+    const cow_set<std::string, Equal, Hash> snapshot(set);
+
+    return std::async(std::launch::async, [snapshot, file]() {
+        save_atomic(snapshot.get(), file);
+    });
+}
+
+#endif // COW_SET_HPP
@@ -0,0 +1,191 @@
+/**
+  @file frozen_set.hpp
+
+  @brief File header della classe frozen_set templata
+
+  File di dichiarazioni/definizioni della classe frozen_set, un set immutabile
+  costruibile a tempo di compilazione
+*/
+
+#ifndef FROZEN_SET_HPP
+#define FROZEN_SET_HPP
+
+#include <array> // std::array
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <functional> // std::less
+#include <initializer_list> // std::initializer_list
+
+/**
+  @brief classe set immutabile constexpr
+
+  La classe implementa un set immutabile di al massimo N oggetti T.
+  Gli elementi vengono deduplicati (tramite Equal) e ordinati (tramite Less)
+  nel costruttore, che è constexpr: se il set è dichiarato constexpr tutto il
+  lavoro viene fatto a tempo di compilazione e contains è utilizzabile in
+  espressioni costanti. A runtime contains è una ricerca binaria senza salti.
+
+  Elementi uguali per Equal devono essere equivalenti per Less.
+  T deve essere un tipo literal con costruttore di default.
+*/
+template <typename T, std::size_t N, typename Equal, typename Less = std::less<T>>
+class frozen_set {
+public:
+    /**
+        TypeDef del tipo contenuto nel set
+    */
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    /**
+        TypeDef dell'iteratore Costante
+    */
+    typedef const value_type* const_iterator;
+private:
+    Equal _eql;
+    Less _less;
+    value_type _array[N == 0 ? 1 : N];
+    size_type _size;
+
+    /**
+        @brief Funzione di supporto che copia, ordina e deduplica
+        una sequenza di elementi in _array.
+
+        @param data puntatore al primo elemento della sequenza
+        @param count numero di elementi della sequenza
+
+        @pre count <= N
+    */
+    constexpr void build(const value_type *data, size_type count) {
+        assert(count <= N);
+
+        for (size_type i = 0; i < count; ++i) {
+            value_type value = data[i];
+            size_type j = i;
+            for (; j > 0 && _less(value, _array[j - 1]); --j)
+                _array[j] = _array[j - 1];
+            _array[j] = value;
+        }
+
+        for (size_type i = 0; i < count; ++i) {
+            if (_size == 0 || !_eql(_array[_size - 1], _array[i]))
+                _array[_size++] = _array[i];
+        }
+    }
+
+public:
+    /**
+        @brief Costruttore da initializer list.
+
+        @param list elementi del set, anche ripetuti
+
+        @pre list.size() <= N
+    */
+    constexpr frozen_set(std::initializer_list<value_type> list) : _eql(), _less(), _array(), _size(0) {
+        build(list.begin(), list.size());
+    }
+
+    /**
+        @brief Costruttore da std::array.
+
+        @param array elementi del set, anche ripetuti
+    */
+    constexpr explicit frozen_set(const std::array<value_type, N> &array) : _eql(), _less(), _array(), _size(0) {
+        build(array.data(), N);
+    }
+
+    /**
+        @brief Funzione che ritorna il numero degli elementi del set.
+
+        @return numero degli elementi nel set
+    */
+    constexpr size_type size(void) const {
+        return _size;
+    }
+
+    /**
+        @brief Operatore getter di una cella dell'array del set.
+
+        @param index della cella da leggere
+        @return reference costante all'elemento da leggere
+
+        @pre index < _size
+    */
+    constexpr const value_type& operator[](const size_type index) const {
+        assert(index < _size);
+        return _array[index];
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di un elemento.
+        La ricerca binaria non ha salti condizionali dipendenti dai dati.
+
+        @param value reference costante dell'elemento da controllare
+
+        @return true se l'elemento è presente nel set, false altrimenti
+    */
+    constexpr bool contains(const value_type &value) const {
+        if (_size == 0)
+            return false;
+
+        const value_type *base = _array;
+        size_type len = _size;
+        while (len > 1) {
+            const size_type half = len / 2;
+            base = _less(base[half], value) ? base + half : base;
+            len -= half;
+        }
+        base += _less(*base, value);
+
+        return base != _array + _size && _eql(*base, value);
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore all'inizio della sequenza dati.
+
+        @return iteratore all'inizio della sequenza dati
+    */
+    constexpr const_iterator begin(void) const {
+        return _array;
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore alla fine della sequenza dati.
+
+        @return iteratore alla fine della sequenza dati
+    */
+    constexpr const_iterator end(void) const {
+        return _array + _size;
+    }
+};
+
+/**
+    @brief Funzione GLOBALE che crea un frozen_set deducendo tipo e
+    numero degli elementi da un array (anche una lista tra graffe).
+
+    @param array elementi del set, anche ripetuti
+
+    @return il frozen_set con gli elementi dell'array
+*/
+template <typename Equal, typename Less, typename T, std::size_t N>
+constexpr frozen_set<T, N, Equal, Less> make_frozen_set(const T (&array)[N]) {
+    std::array<T, N> tmp{};
+    for (std::size_t i = 0; i < N; ++i)
+        tmp[i] = array[i];
+    return frozen_set<T, N, Equal, Less>(tmp);
+}
+
+/**
+    @brief Funzione GLOBALE che crea un frozen_set ordinato con std::less
+    deducendo tipo e numero degli elementi da un array.
+
+    @param array elementi del set, anche ripetuti
+
+    @return il frozen_set con gli elementi dell'array
+*/
+template <typename Equal, typename T, std::size_t N>
+constexpr frozen_set<T, N, Equal> make_frozen_set(const T (&array)[N]) {
+    return make_frozen_set<Equal, std::less<T>>(array);
+}
+
+#endif // FROZEN_SET_HPP
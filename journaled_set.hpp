@@ -0,0 +1,474 @@
+/**
+  @file journaled_set.hpp
+
+  @brief File header della classe journaled_set templata
+
+  File di dichiarazioni/definizioni della classe journaled_set, un set
+  persistente con un log binario delle modifiche (journal)
+*/
+
+#ifndef JOURNALED_SET_HPP
+#define JOURNALED_SET_HPP
+
+#include <cstdint> // std::uint32_t, std::uint64_t
+#include <cstdio> // std::FILE, std::fopen, std::fwrite, std::fread
+#include <filesystem> // std::filesystem::resize_file
+#include <system_error> // std::error_code
+#include <stdexcept> // std::runtime_error
+#include <string> // std::string
+#include <type_traits> // std::is_trivially_copyable
+#include <vector> // std::vector
+#include "set.hpp"
+
+/**
+  @brief Codifica binaria degli elementi nel journal e nello snapshot:
+  i byte dell'oggetto, per i tipi trivially copyable. Il formato usa
+  l'endianness della macchina.
+*/
+template <typename T>
+struct journal_codec {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "journal_codec: serve una specializzazione per i tipi non trivially copyable");
+
+    /**
+        @brief Funzione che accoda la codifica di un elemento.
+
+        @param value elemento da codificare
+        @param out buffer a cui accodare i byte
+    */
+    static void encode(const T &value, std::string &out) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+        @brief Funzione che legge un elemento.
+
+        @param in file da cui leggere
+        @param value elemento letto
+
+        @return true se l'elemento è stato letto per intero, false altrimenti
+    */
+    static bool decode(std::FILE *in, T &value) {
+        return std::fread(&value, sizeof(T), 1, in) == 1;
+    }
+};
+
+/**
+  @brief Codifica binaria delle stringhe: lunghezza a 32 bit e caratteri.
+*/
+template <>
+struct journal_codec<std::string> {
+    static void encode(const std::string &value, std::string &out) {
+        const std::uint32_t length = static_cast<std::uint32_t>(value.size());
+        out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.append(value);
+    }
+
+    static bool decode(std::FILE *in, std::string &value) {
+        std::uint32_t length;
+        if (std::fread(&length, sizeof(length), 1, in) != 1)
+            return false;
+        value.resize(length);
+        return length == 0 || std::fread(&value[0], 1, length, in) == length;
+    }
+};
+
+/**
+  @brief classe set con journal delle modifiche
+
+  La classe mantiene un set in memoria e la sua copia su disco in due file:
+  uno snapshot completo (path) e un log in sola aggiunta (path.log) in cui
+  ogni add/remove riuscita accoda un record binario (operazione + elemento).
+  Il costo di I/O di una modifica è quindi proporzionale alla modifica e
+  non alla dimensione del set. Il costruttore ricostruisce il set caricando
+  lo snapshot e rieseguendo il log; compact scrive un nuovo snapshot
+  (in modo atomico, vedi write_atomic) e svuota il log.
+
+  Rieseguire un log su uno snapshot che lo contiene già non cambia il set,
+  quindi un'interruzione durante compact non perde modifiche. Un record
+  incompleto in fondo al log (crash durante una scrittura) viene scartato.
+  Se una scrittura fallisce a metà, il log viene troncato alla fine
+  dell'ultimo record completo; se nemmeno questo riesce, il log resta
+  chiuso e le modifiche falliscono finché compact non lo riscrive.
+  I record sono scritti con stdio: sync li porta su disco.
+*/
+template <typename T, typename Equal, typename Hash = null_hash, typename Codec = journal_codec<T>>
+class journaled_set {
+public:
+    /**
+        TypeDef del tipo contenuto nel set e del set in memoria
+    */
+    typedef T value_type;
+    typedef set<T, Equal, Hash> set_type;
+    typedef typename set_type::size_type size_type;
+
+    /**
+        TypeDef dell'iteratore Costante
+    */
+    typedef typename set_type::const_iterator const_iterator;
+private:
+    /**
+        Codici delle operazioni nei record del log
+    */
+    enum operation : char { op_add = 'A', op_remove = 'R' };
+
+    set_type _set;
+    std::string _path;
+    std::FILE *_log; // nullptr se il log non è scrivibile
+    std::size_t _log_records; // record nel log dall'ultimo compact
+    std::uintmax_t _log_bytes; // byte dei record completi nel log
+    std::string _record; // buffer riusato per codificare un record
+
+    journaled_set(const journaled_set &other); // non copiabile
+    journaled_set& operator=(const journaled_set &other);
+
+    /**
+        @brief Funzione di supporto che ritorna il percorso del log.
+
+        @return percorso del log
+    */
+    std::string log_path(void) const {
+        return _path + ".log";
+    }
+
+    /**
+        @brief Funzione di supporto che carica lo snapshot, se esiste.
+        Gli elementi vengono prima decodificati e poi inseriti nel set
+        con la costruzione in blocco (una sola allocazione).
+
+        @throw std::runtime_error se lo snapshot è danneggiato
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void load_snapshot(void) {
+        std::FILE *in = std::fopen(_path.c_str(), "rb");
+        if (in == nullptr)
+            return;
+
+        std::uint64_t count;
+        bool ok = std::fread(&count, sizeof(count), 1, in) == 1;
+        std::vector<value_type> values;
+        value_type value;
+        try {
+            for (std::uint64_t i = 0; ok && i < count; ++i) {
+                ok = Codec::decode(in, value);
+                if (ok)
+                    values.push_back(value);
+            }
+        } catch(...) {
+            std::fclose(in);
+            throw;
+        }
+        std::fclose(in);
+
+        if (!ok)
+            throw std::runtime_error("journaled_set: snapshot danneggiato " + _path);
+
+        set_type loaded(parallel_policy(), values.begin(), values.end());
+        _set.swap(loaded);
+    }
+
+    /**
+        @brief Funzione di supporto che riesegue il log sul set.
+
+        @return true se il log è stato letto per intero, false se
+        termina con un record incompleto
+
+        @throw std::runtime_error se il log contiene un'operazione sconosciuta
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool replay_log(void) {
+        std::FILE *in = std::fopen(log_path().c_str(), "rb");
+        if (in == nullptr)
+            return true;
+
+        bool complete = true;
+        value_type value;
+        try {
+            int op;
+            while ((op = std::fgetc(in)) != EOF) {
+                if (!Codec::decode(in, value)) {
+                    complete = false;
+                    break;
+                }
+                if (op == op_add)
+                    _set.add(value);
+                else if (op == op_remove)
+                    _set.remove(value);
+                else
+                    throw std::runtime_error("journaled_set: log danneggiato " + log_path());
+                ++_log_records;
+            }
+        } catch(...) {
+            std::fclose(in);
+            throw;
+        }
+        std::fclose(in);
+        return complete;
+    }
+
+    /**
+        @brief Funzione di supporto che accoda un record al log.
+
+        @param op operazione
+        @param value elemento
+
+        @return true se il record è stato scritto, false altrimenti
+    */
+    bool append(operation op, const value_type &value) {
+        if (_log == nullptr)
+            return false;
+
+        _record.assign(1, static_cast<char>(op));
+        Codec::encode(value, _record);
+        if (std::fwrite(_record.data(), 1, _record.size(), _log) != _record.size()) {
+            discard_torn_record();
+            return false;
+        }
+        ++_log_records;
+        _log_bytes += _record.size();
+        return true;
+    }
+
+    /**
+        @brief Funzione di supporto che, dopo una scrittura fallita, chiude
+        il log (fclose scrive i byte ancora nel buffer, compresi quelli del
+        record incompleto), lo tronca alla fine dell'ultimo record completo
+        e lo riapre. Se il log è più corto (lo svuotamento del buffer non è
+        riuscito e mancano record precedenti) o il troncamento o la
+        riapertura falliscono, il log resta chiuso.
+    */
+    void discard_torn_record(void) {
+        std::fclose(_log);
+        _log = nullptr;
+
+        std::error_code error;
+        const std::uintmax_t size = std::filesystem::file_size(log_path(), error);
+        if (error || size < _log_bytes)
+            return;
+        std::filesystem::resize_file(log_path(), _log_bytes, error);
+        if (!error)
+            _log = std::fopen(log_path().c_str(), "ab");
+    }
+
+public:
+    /**
+        @brief Costruttore che apre (o crea) il set persistente in path,
+        caricando lo snapshot e rieseguendo il log.
+
+        @param path percorso dello snapshot, il log è path.log
+
+        @throw std::runtime_error se i file non sono leggibili o scrivibili
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    explicit journaled_set(const std::string &path) : _path(path), _log(nullptr), _log_records(0), _log_bytes(0) {
+        try {
+            load_snapshot();
+            if (!replay_log())
+                compact();
+        } catch(...) {
+            if (_log != nullptr)
+                std::fclose(_log);
+            throw;
+        }
+
+        if (_log == nullptr) {
+            _log = std::fopen(log_path().c_str(), "ab");
+            if (_log == nullptr)
+                throw std::runtime_error("journaled_set: impossibile aprire " + log_path());
+            std::error_code error;
+            _log_bytes = std::filesystem::file_size(log_path(), error);
+            if (error) {
+                std::fclose(_log);
+                throw std::runtime_error("journaled_set: impossibile aprire " + log_path());
+            }
+        }
+    }
+
+    /**
+        @brief Distruttore, chiude il log (senza sync).
+    */
+    ~journaled_set() {
+        if (_log != nullptr)
+            std::fclose(_log);
+    }
+
+    /**
+        @brief Funzione che ritorna il set in memoria (sola lettura).
+
+        @return reference costante al set
+    */
+    const set_type& get(void) const {
+        return _set;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero degli elementi del set.
+
+        @return numero degli elementi nel set
+    */
+    size_type size(void) const {
+        return _set.size();
+    }
+
+    /**
+        @brief Funzione che ritorna il numero di record nel log
+        dall'ultimo compact.
+
+        @return numero di record nel log
+    */
+    std::size_t log_records(void) const {
+        return _log_records;
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di un elemento.
+
+        @param value reference costante dell'elemento da controllare
+
+        @return true se l'elemento è presente nel set, false altrimenti
+    */
+    bool contains(const value_type &value) const {
+        return _set.contains(value);
+    }
+
+    /**
+        @brief Funzione che aggiunge un elemento al set e, se aggiunto,
+        accoda l'operazione al log.
+
+        @param value reference costante dell'elemento da aggiungere
+
+        @return true se aggiunto con successo, false altrimenti
+
+        @throw std::runtime_error se il log non è scrivibile (il set non cambia)
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool add(const value_type &value) {
+        if (!_set.add(value))
+            return false;
+
+        if (!append(op_add, value)) {
+            _set.remove(value);
+            throw std::runtime_error("journaled_set: impossibile scrivere " + log_path());
+        }
+        return true;
+    }
+
+    /**
+        @brief Funzione che rimuove un elemento dal set e, se rimosso,
+        accoda l'operazione al log.
+
+        @param value reference costante dell'elemento da rimuovere
+
+        @return true se rimosso con successo, false altrimenti
+
+        @throw std::runtime_error se il log non è scrivibile (il set non cambia)
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool remove(const value_type &value) {
+        if (!_set.remove(value))
+            return false;
+
+        if (!append(op_remove, value)) {
+            _set.add(value);
+            throw std::runtime_error("journaled_set: impossibile scrivere " + log_path());
+        }
+        return true;
+    }
+
+    /**
+        @brief Funzione che porta su disco i record accodati al log.
+
+        @throw std::runtime_error se la scrittura fallisce
+    */
+    void sync(void) {
+        bool ok = _log != nullptr && std::fflush(_log) == 0;
+#if defined(__unix__) || defined(__APPLE__)
+        ok = ok && fsync(fileno(_log)) == 0;
+#endif
+        if (!ok)
+            throw std::runtime_error("journaled_set: impossibile scrivere " + log_path());
+    }
+
+    /**
+        @brief Funzione che scrive uno snapshot del set e svuota il log.
+        Se fallisce il log precedente resta in uso.
+
+        @post log_records() == 0
+
+        @throw std::runtime_error se la scrittura fallisce
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void compact(void) {
+        if (_log != nullptr)
+            std::fflush(_log);
+
+        write_atomic(_path, [this](std::ostream &os) {
+            std::string buffer;
+            const std::uint64_t count = _set.size();
+            buffer.append(reinterpret_cast<const char*>(&count), sizeof(count));
+
+            for (const_iterator curr = _set.begin(); curr != _set.end(); ++curr) {
+                Codec::encode(*curr, buffer);
+                if (buffer.size() >= output_buffer::buffer_size) {
+                    os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    buffer.clear();
+                }
+            }
+            os.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        });
+
+        std::FILE *log = std::fopen(log_path().c_str(), "wb");
+        if (log == nullptr)
+            throw std::runtime_error("journaled_set: impossibile aprire " + log_path());
+        if (_log != nullptr)
+            std::fclose(_log);
+        _log = log;
+        _log_records = 0;
+        _log_bytes = 0;
+        sync();
+    }
+
+    /**
+        @brief Funzione che svuota il set, con uno snapshot vuoto.
+
+        @post size() == 0
+
+        @throw std::runtime_error se la scrittura fallisce
+    */
+    void clear(void) {
+        _set.clear();
+        compact();
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore all'inizio della sequenza dati.
+
+        @return iteratore all'inizio della sequenza dati
+    */
+    const_iterator begin(void) const {
+        return _set.begin();
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore alla fine della sequenza dati.
+
+        @return iteratore alla fine della sequenza dati
+    */
+    const_iterator end(void) const {
+        return _set.end();
+    }
+
+    /**
+        @brief Funzione GLOBALE che implementa l'operatore di stream.
+
+        @param os stream di output
+        @param ol set da spedire sullo stream
+
+        @return lo stream di output
+    */
+    friend std::ostream& operator<<(std::ostream &os, const journaled_set &ol) {
+        return os << ol._set;
+    }
+};
+
+#endif // JOURNALED_SET_HPP
@@ -7,20 +7,46 @@
 #include <cassert>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <stdexcept>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <fstream>
+#include <future>
+#include <cstdio>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <filesystem>
+#include <csignal>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 #include "set.hpp"
+#include "frozen_set.hpp"
+#include "projected_set.hpp"
+#include "cow_set.hpp"
+#include "roaring_set.hpp"
+#include "set_generator.hpp"
+#include "journaled_set.hpp"
+#include "set_sketch.hpp"
+#include "string_set.hpp"
+#include "buffered_inserter.hpp"
 
 using std::cout;
 using std::endl;
 using std::vector;
 
 struct equal_char {
-    bool operator()(const char &p1, const char &p2) const {
+    constexpr bool operator()(const char &p1, const char &p2) const {
         return (p1==p2);
     }
 };
 
 struct equal_int {
-    bool operator()(int a, int b) const {
+    constexpr bool operator()(int a, int b) const {
         return a==b;
     }
 };
@@ -45,7 +71,14 @@ struct is_bigger_than {
     }
 };
 
+struct hash_int {
+    std::size_t operator()(int a) const {
+        return static_cast<std::size_t>(a);
+    }
+};
+
 typedef set<int, equal_int> IntSet;
+typedef set<int, equal_int, hash_int> HashIntSet;
 
 /**
   @brief Test Base
@@ -639,6 +672,1444 @@ void test_set_capacity(void) {
     cout << "!!!! TEST_SET_CAPACITY SUCCESS!" << endl;
 }
 
+/**
+  @brief Test Digest
+*/
+void test_digest(void) {
+    cout << "!!!! TEST_DIGEST START" << endl;
+    HashIntSet set1, set2;
+
+    for (int i = 0; i < 1000; i++)
+        set1.add(i);
+    for (int i = 999; i >= 0; i--)
+        set2.add(i);
+
+    cout << "!! DIGEST" << endl;
+    assert(set1.digest() == set2.digest());
+    assert(set1 == set2);
+
+    set2.remove(500);
+    assert(set1.digest() != set2.digest());
+    assert(!(set1 == set2));
+
+    set2.add(500);
+    assert(set1.digest() == set2.digest());
+    assert(set1 == set2);
+
+    cout << "!! OPERATOR== SAME SIZE" << endl;
+    set2.remove(0);
+    set2.add(1000);
+    assert(set1.size() == set2.size());
+    assert(!(set1 == set2));
+
+    const HashIntSet set3(set1);
+    assert(set3.digest() == set1.digest());
+    assert(set3 == set1);
+
+    HashIntSet empty1, empty2;
+    assert(empty1 == empty2);
+    assert(empty1.digest() == 0);
+
+    cout << "!! NULL_HASH" << endl;
+    IntSet set4, set5;
+    set4.add(1);
+    set4.add(2);
+    set5.add(2);
+    set5.add(3);
+    assert(set4.digest() == set5.digest());
+    assert(!(set4 == set5));
+
+    cout << "!!!! TEST_DIGEST SUCCESS!" << endl;
+}
+
+struct equal_string_view {
+    constexpr bool operator()(std::string_view a, std::string_view b) const {
+        return a == b;
+    }
+};
+
+/**
+  @brief Test Frozen Set
+*/
+void test_frozen_set(void) {
+    cout << "!!!! TEST_FROZEN_SET START" << endl;
+
+    cout << "!! CONSTEXPR" << endl;
+    constexpr auto vowels = make_frozen_set<equal_char>({'u', 'a', 'e', 'a', 'i', 'o', 'u'});
+    static_assert(vowels.size() == 5, "duplicati non rimossi");
+    static_assert(vowels.contains('a'), "a mancante");
+    static_assert(vowels.contains('u'), "u mancante");
+    static_assert(!vowels.contains('b'), "b presente");
+    static_assert(!vowels.contains('z'), "z presente");
+
+    constexpr frozen_set<int, 6, equal_int> numbers(std::array<int, 6>{{8, 3, 5, 3, 1, 8}});
+    static_assert(numbers.size() == 4, "duplicati non rimossi");
+    static_assert(numbers.contains(1) && numbers.contains(8), "elementi mancanti");
+    static_assert(!numbers.contains(0) && !numbers.contains(9), "elementi presenti");
+
+    constexpr frozen_set<std::string_view, 4, equal_string_view> keywords{"if", "else", "while", "if"};
+    static_assert(keywords.size() == 3, "duplicati non rimossi");
+    static_assert(keywords.contains("while"), "while mancante");
+    static_assert(!keywords.contains("for"), "for presente");
+
+    cout << "!! RUNTIME" << endl;
+    for (int i = -5; i < 15; i++)
+        assert(numbers.contains(i) == (i == 1 || i == 3 || i == 5 || i == 8));
+
+    const frozen_set<int, 3, equal_int> single(std::array<int, 3>{{1, 1, 1}});
+    assert(single.size() == 1);
+    assert(single.contains(1));
+    assert(!single.contains(2));
+
+    cout << "!! CONST_ITERATOR" << endl;
+    int index = 0;
+    for (auto curr = vowels.begin(); curr != vowels.end(); ++curr)
+        assert(*curr == vowels[index++]);
+    assert(index == 5);
+
+    cout << "!!!! TEST_FROZEN_SET SUCCESS!" << endl;
+}
+
+struct KeyValueIntObjKeyOf {
+    int operator()(const KeyValueIntObj &obj) const {
+        return obj.key;
+    }
+};
+
+struct complexObjKeyOf {
+    const std::string& operator()(const complexObj &obj) const {
+        return obj._key;
+    }
+};
+
+struct equal_string {
+    bool operator()(const std::string &str1, const std::string &str2) const {
+        return str1 == str2;
+    }
+};
+
+/**
+  @brief Test Projected Set
+*/
+void test_projected_set(void) {
+    cout << "!!!! TEST_PROJECTED_SET START" << endl;
+    using std::string;
+
+    cout << "!! ADD/REMOVE" << endl;
+    projected_set<KeyValueIntObj, KeyValueIntObjKeyOf, equal_int, hash_int> kvSet;
+
+    for (int i = 0; i < 100; i++)
+        assert(kvSet.add(KeyValueIntObj(i, i * 10)));
+    assert(!kvSet.add(KeyValueIntObj(5, 0)));
+    assert(kvSet.size() == 100);
+
+    for (int i = 0; i < 100; i += 2)
+        assert(kvSet.remove(i));
+    assert(!kvSet.remove(0));
+    assert(kvSet.size() == 50);
+
+    cout << "!! FIND" << endl;
+    for (int i = 0; i < 100; i++) {
+        const KeyValueIntObj *found = kvSet.find(i);
+        assert((found != nullptr) == (i % 2 == 1));
+        assert(kvSet.contains(i) == (i % 2 == 1));
+        if (found != nullptr)
+            assert(found->value == i * 10);
+    }
+
+    cout << "!! KEYS/CONST_ITERATOR" << endl;
+    int index = 0;
+    for (auto curr = kvSet.begin(); curr != kvSet.end(); ++curr) {
+        assert(curr->key == kvSet.keys()[index]);
+        assert(curr->key == kvSet[index++].key);
+    }
+    assert(index == 50);
+
+    cout << "!! COPY CONSTRUCTOR/OPERATOR=" << endl;
+    projected_set<complexObj, complexObjKeyOf, equal_string> objSet;
+    objSet.add(complexObj(string("c++"), 9, string("corso informatica")));
+    objSet.add(complexObj(string("analisi 1"), 8, string("corso informatica")));
+    assert(!objSet.add(complexObj(string("c++"), 5, string("corso psicologia"))));
+
+    const projected_set<complexObj, complexObjKeyOf, equal_string> objSet2(objSet);
+    projected_set<complexObj, complexObjKeyOf, equal_string> objSet3;
+    objSet3 = objSet2;
+    objSet.remove(string("c++"));
+
+    assert(objSet.size() == 1);
+    assert(objSet3.size() == 2);
+    assert(objSet3.find(string("c++"))->_value == 9);
+    assert(objSet2.keys() == objSet3.keys());
+
+    cout << "!!!! TEST_PROJECTED_SET SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Erase If
+*/
+void test_erase_if(void) {
+    cout << "!!!! TEST_ERASE_IF START" << endl;
+
+    cout << "!! ERASE_IF" << endl;
+    HashIntSet set;
+    for (int i = 0; i < 1000; i++)
+        set.add(i);
+
+    assert(set.erase_if(is_bigger_than(99)) == 900);
+    assert(set.size() == 100);
+    assert(set.capacity() / 2 < set.size());
+    for (int i = 0; i < 1000; i++)
+        assert(set.contains(i) == (i < 100));
+
+    HashIntSet expected;
+    for (int i = 0; i < 100; i++)
+        expected.add(i);
+    assert(set == expected);
+
+    assert(set.erase_if(is_bigger_than(1000)) == 0);
+    assert(set.size() == 100);
+
+    cout << "!! REMOVE_ALL" << endl;
+    vector<int> toRemove {0, 2, 4, 4, 200, 98};
+    assert(set.remove_all(toRemove.begin(), toRemove.end()) == 4);
+    assert(set.size() == 96);
+    assert(!set.contains(0) && !set.contains(4) && !set.contains(98));
+    assert(set.contains(1) && set.contains(99));
+
+    IntSet intSet;
+    for (int i = 0; i < 10; i++)
+        intSet.add(i);
+    assert(intSet.remove_all(toRemove.begin(), toRemove.end()) == 3);
+    assert(intSet.size() == 7);
+
+    cout << "!! SVUOTAMENTO" << endl;
+    assert(intSet.erase_if(is_bigger_than(-1)) == 7);
+    assert(intSet.size() == 0);
+    assert(intSet.capacity() == 0);
+
+    cout << "!!!! TEST_ERASE_IF SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Cow Set
+*/
+void test_cow_set(void) {
+    cout << "!!!! TEST_COW_SET START" << endl;
+    typedef cow_set<int, equal_int, hash_int> CowIntSet;
+
+    cout << "!! COPY CONSTRUCTOR" << endl;
+    CowIntSet cowSet;
+    for (int i = 0; i < 100; i++)
+        assert(cowSet.add(i));
+    assert(!cowSet.shared());
+
+    CowIntSet cowSet2(cowSet);
+    assert(cowSet.shared() && cowSet2.shared());
+    assert(cowSet.begin() == cowSet2.begin());
+    assert(cowSet == cowSet2);
+
+    cout << "!! COPY ON WRITE" << endl;
+    assert(!cowSet2.add(5));
+    assert(!cowSet2.remove(500));
+    assert(cowSet2.shared());
+
+    assert(cowSet2.add(100));
+    assert(!cowSet.shared() && !cowSet2.shared());
+    assert(cowSet.begin() != cowSet2.begin());
+    assert(cowSet.size() == 100);
+    assert(cowSet2.size() == 101);
+    assert(!cowSet.contains(100));
+    assert(!(cowSet == cowSet2));
+
+    cout << "!! OPERATOR=" << endl;
+    CowIntSet cowSet3;
+    cowSet3 = cowSet2;
+    cowSet3 = cowSet3;
+    assert(cowSet3.shared());
+    assert(cowSet3.remove(0));
+    assert(cowSet2.contains(0));
+    assert(!cowSet3.contains(0));
+    assert(cowSet3.digest() != cowSet2.digest());
+
+    cout << "!! SET" << endl;
+    const CowIntSet cowSet4(cowSet.get());
+    assert(cowSet4 == cowSet);
+    assert(cowSet4.get() == cowSet.get());
+
+    CowIntSet empty;
+    assert(empty.size() == 0);
+    assert(empty.begin() == empty.end());
+    assert(!empty.remove(1));
+
+    cout << "!!!! TEST_COW_SET SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Size Type And Storage
+*/
+void test_size_type_storage(void) {
+    cout << "!!!! TEST_SIZE_TYPE_STORAGE START" << endl;
+
+    cout << "!! SIZE_TYPE A 8 BIT" << endl;
+    set<int, equal_int, hash_int, unsigned char> smallSet;
+    assert(smallSet.max_size() == 255);
+    for (int i = 0; i < 255; i++)
+        assert(smallSet.add(i));
+    assert(smallSet.size() == 255);
+    assert(smallSet.capacity() == 255);
+    assert(!smallSet.add(0));
+
+    bool thrown = false;
+    try {
+        smallSet.add(255);
+    } catch(const std::length_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(smallSet.size() == 255);
+    assert(smallSet.remove(254));
+    assert(smallSet.add(255));
+
+    cout << "!! SIZE_TYPE A 64 BIT" << endl;
+    set<int, equal_int, hash_int, unsigned long long> bigSet;
+    assert(bigSet.max_size() == 18446744073709551615ULL);
+    for (int i = 0; i < 100; i++)
+        bigSet.add(i);
+    assert(bigSet.size() == 100);
+    assert(bigSet.erase_if(is_bigger_than(49)) == 50);
+
+    cout << "!! HUGE_PAGE_STORAGE" << endl;
+    typedef set<int, equal_int, hash_int, unsigned int, huge_page_storage<4096> > HugeIntSet;
+    vector<int> values;
+    for (int i = 0; i < 5000; i++)
+        values.push_back(i);
+    HugeIntSet hugeSet(values.begin(), values.end());
+    const HugeIntSet hugeSet2(hugeSet);
+    assert(hugeSet.size() == 5000);
+    assert(hugeSet.capacity() == 8192); // crescita geometrica, non di MAX_RESIZE
+    assert(hugeSet == hugeSet2);
+    for (int i = 0; i < 5000; i += 7)
+        assert(hugeSet2.contains(i));
+    assert(hugeSet.erase_if(is_bigger_than(9)) == 4990);
+    assert(hugeSet.size() == 10);
+
+    cout << "!!!! TEST_SIZE_TYPE_STORAGE SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Parallel Ctor
+*/
+void test_parallel_ctor(void) {
+    cout << "!!!! TEST_PARALLEL_CTOR START" << endl;
+
+    vector<int> values;
+    for (int i = 0; i < 20000; i++)
+        values.push_back((i * 7919) % 5003);
+
+    cout << "!! CTOR PARALLELO" << endl;
+    const HashIntSet parallelSet(parallel_policy(4), values.begin(), values.end());
+    assert(parallelSet.size() == 5003);
+    assert(parallelSet.capacity() == parallelSet.size());
+    for (int i = 0; i < 5003; i++)
+        assert(parallelSet.contains(i));
+    assert(!parallelSet.contains(5003));
+
+    HashIntSet expected;
+    for (int i = 0; i < 5003; i++)
+        expected.add(i);
+    assert(parallelSet == expected);
+
+    const HashIntSet defaultSet(parallel_policy(), values.begin(), values.end());
+    assert(defaultSet == parallelSet);
+
+    cout << "!! CTOR PARALLELO SENZA HASH" << endl;
+    vector<int> values2 {1,2,3,4,5,1,3,4,5,8,6,7,8,1};
+    const IntSet intSet(parallel_policy(4), values2.begin(), values2.end());
+    const IntSet intSet2(values2.begin(), values2.end());
+    assert(intSet == intSet2);
+    assert(intSet.size() == 8);
+
+    const IntSet emptySet(parallel_policy(4), values2.begin(), values2.begin());
+    assert(emptySet.size() == 0);
+
+    cout << "!!!! TEST_PARALLEL_CTOR SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Union And Intersect All
+*/
+void test_union_intersect_all(void) {
+    cout << "!!!! TEST_UNION_INTERSECT_ALL START" << endl;
+
+    vector<HashIntSet> sets(5);
+    for (int s = 0; s < 5; s++) {
+        for (int i = s; i < 100; i += s + 1)
+            sets[s].add(i);
+    }
+
+    cout << "!! UNION_ALL" << endl;
+    HashIntSet expectedUnion;
+    for (int s = 0; s < 5; s++)
+        expectedUnion = expectedUnion + sets[s];
+
+    const HashIntSet unionSet = union_all(sets.begin(), sets.end());
+    assert(unionSet == expectedUnion);
+    assert(unionSet.digest() == expectedUnion.digest());
+    assert(unionSet.size() == 100);
+    assert(unionSet.capacity() == unionSet.size());
+
+    cout << "!! INTERSECT_ALL" << endl;
+    HashIntSet expectedIntersection = sets[0];
+    for (int s = 1; s < 5; s++)
+        expectedIntersection = expectedIntersection - sets[s];
+
+    const HashIntSet intersectionSet = intersect_all(sets.begin(), sets.end());
+    assert(intersectionSet == expectedIntersection);
+    for (auto curr = intersectionSet.begin(); curr != intersectionSet.end(); ++curr) {
+        for (int s = 0; s < 5; s++)
+            assert(sets[s].contains(*curr));
+    }
+
+    cout << "!! INPUT CON INDICE/CONGELATI" << endl;
+    vector<HashIntSet> bigSets(3);
+    for (int i = 0; i < 1000; i++) {
+        bigSets[0].add(i);
+        if (i % 2 == 0)
+            bigSets[1].add(i);
+        if (i % 3 == 0)
+            bigSets[2].add(i);
+    }
+    bigSets[2].freeze();
+    assert(bigSets[0].indexed() && bigSets[1].indexed() && bigSets[2].frozen());
+    const HashIntSet bigIntersection = intersect_all(bigSets.begin(), bigSets.end());
+    assert(bigIntersection.size() == 167);
+    for (int i = 0; i < 1000; i += 6)
+        assert(bigIntersection.contains(i));
+    assert(bigSets[2].frozen());
+    const HashIntSet bigUnion = union_all(bigSets.begin(), bigSets.end());
+    assert(bigUnion.size() == 1000 && bigUnion.capacity() == 1000);
+    assert(bigUnion.indexed());
+
+    sets.push_back(HashIntSet());
+    assert(intersect_all(sets.begin(), sets.end()).size() == 0);
+    assert(union_all(sets.begin(), sets.end()) == unionSet);
+
+    cout << "!! SEQUENZA VUOTA/SENZA HASH" << endl;
+    assert(union_all(sets.begin(), sets.begin()).size() == 0);
+    assert(intersect_all(sets.begin(), sets.begin()).size() == 0);
+
+    vector<IntSet> intSets(2);
+    intSets[0].add(1);
+    intSets[0].add(2);
+    intSets[1].add(2);
+    intSets[1].add(3);
+    assert(union_all(intSets.begin(), intSets.end()).size() == 3);
+    assert(intersect_all(intSets.begin(), intSets.end()).size() == 1);
+    assert(intersect_all(intSets.begin(), intSets.end()).contains(2));
+
+    cout << "!!!! TEST_UNION_INTERSECT_ALL SUCCESS!" << endl;
+}
+
+/**
+  @brief Funzione che scrive un set con il formato originale dell'operatore di stream.
+*/
+template <typename Set>
+std::string reference_output(const Set &set) {
+    std::ostringstream os;
+    os << set.size();
+    for (auto curr = set.begin(); curr != set.end(); ++curr)
+        os << " (" << *curr << ")";
+    return os.str();
+}
+
+/**
+  @brief Funzione che scrive un set con l'operatore di stream.
+*/
+template <typename Set>
+std::string stream_output(const Set &set) {
+    std::ostringstream os;
+    os << set;
+    return os.str();
+}
+
+struct equal_double {
+    bool operator()(double a, double b) const {
+        return a == b;
+    }
+};
+
+struct equal_bool {
+    bool operator()(bool a, bool b) const {
+        return a == b;
+    }
+};
+
+/**
+  @brief Test Buffered Output
+*/
+void test_buffered_output(void) {
+    cout << "!!!! TEST_BUFFERED_OUTPUT START" << endl;
+
+    cout << "!! INTERI" << endl;
+    vector<int> ints;
+    for (int i = -20000; i < 20000; i += 3)
+        ints.push_back(i);
+    const HashIntSet intSet(ints.begin(), ints.end());
+    assert(stream_output(intSet) == reference_output(intSet));
+
+    cout << "!! VIRGOLA MOBILE" << endl;
+    set<double, equal_double> doubleSet;
+    doubleSet.add(0.0);
+    doubleSet.add(-1.5);
+    doubleSet.add(3.14159265358979);
+    doubleSet.add(1e-7);
+    doubleSet.add(123456789.0);
+    doubleSet.add(1e300);
+    doubleSet.add(100000.0);
+    doubleSet.add(1.0 / 3.0);
+    assert(stream_output(doubleSet) == reference_output(doubleSet));
+
+    cout << "!! CARATTERI/BOOL/STRINGHE" << endl;
+    set<char, equal_char> charSet;
+    charSet.add('a');
+    charSet.add(' ');
+    charSet.add(')');
+    assert(stream_output(charSet) == reference_output(charSet));
+
+    set<bool, equal_bool> boolSet;
+    boolSet.add(true);
+    boolSet.add(false);
+    assert(stream_output(boolSet) == reference_output(boolSet));
+
+    set<std::string, equal_string> stringSet;
+    stringSet.add(std::string("best"));
+    stringSet.add(std::string(""));
+    stringSet.add(std::string(100000, 'x'));
+    stringSet.add(std::string("è"));
+    assert(stream_output(stringSet) == reference_output(stringSet));
+
+    cout << "!! STREAM NON DI DEFAULT" << endl;
+    std::ostringstream hexStream, hexReference;
+    hexStream << std::hex << intSet;
+    hexReference << std::hex << intSet.size();
+    for (auto curr = intSet.begin(); curr != intSet.end(); ++curr)
+        hexReference << " (" << *curr << ")";
+    assert(hexStream.str() == hexReference.str());
+
+    cout << "!! TIPI NON NUMERICI" << endl;
+    set<complexObj, complexObj_equal> objSet;
+    objSet.add(complexObj(std::string("c++"), 9, std::string("corso informatica")));
+    cout << "SET : " << objSet << endl;
+
+    cout << "!!!! TEST_BUFFERED_OUTPUT SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Roaring Set
+*/
+void test_roaring_set(void) {
+    cout << "!!!! TEST_ROARING_SET START" << endl;
+
+    cout << "!! ADD/REMOVE/CONTAINS" << endl;
+    roaring_set<int> roaring;
+    roaring_set<int>::size_type expectedSize = 0;
+    for (int i = -70000; i < 70000; i += 3, expectedSize++)
+        assert(roaring.add(i));
+    for (int i = 1000000; i < 1010000; i++, expectedSize++)
+        assert(roaring.add(i));
+    assert(!roaring.add(-70000));
+    assert(!roaring.add(1000000));
+    assert(roaring.size() == expectedSize);
+
+    auto sparse = [](int i) {
+        return i >= -70000 && i < 70000 && (i + 70000) % 3 == 0;
+    };
+    for (int i = -80000; i < 80000; i++)
+        assert(roaring.contains(i) == sparse(i));
+
+    for (int i = 1000000; i < 1009000; i += 2, expectedSize--)
+        assert(roaring.remove(i));
+    assert(!roaring.remove(1000000));
+    assert(!roaring.remove(5000000));
+    assert(roaring.size() == expectedSize);
+
+    auto dense = [](int i) {
+        return i >= 1000000 && i < 1010000 && (i >= 1009000 || i % 2 == 1);
+    };
+    for (int i = 999990; i < 1010010; i++)
+        assert(roaring.contains(i) == dense(i));
+
+    cout << "!! CONST_ITERATOR" << endl;
+    roaring_set<int>::size_type count = 0;
+    int previous = 0;
+    for (auto curr = roaring.begin(); curr != roaring.end(); ++curr) {
+        assert(count == 0 || previous < *curr);
+        assert(sparse(*curr) || dense(*curr));
+        previous = *curr;
+        ++count;
+    }
+    assert(count == roaring.size());
+
+    cout << "!! RUN_OPTIMIZE" << endl;
+    roaring_set<unsigned int> range;
+    for (unsigned int i = 0; i < 200000; i++)
+        range.add(i);
+    const roaring_set<unsigned int> rangeCopy(range);
+    const std::size_t bytesBefore = range.bytes();
+    assert(range.run_optimize() > 0);
+    assert(range.bytes() < bytesBefore);
+    assert(range == rangeCopy);
+    assert(range.contains(0) && range.contains(199999) && !range.contains(200000));
+    assert(range.remove(100000));
+    assert(!range.contains(100000));
+    assert(range.add(100000));
+    assert(range == rangeCopy);
+
+    cout << "!! OPERATOR+/-" << endl;
+    roaring_set<unsigned int> evens, thirds;
+    for (unsigned int i = 0; i < 300000; i += 2)
+        evens.add(i);
+    for (unsigned int i = 0; i < 300000; i += 3)
+        thirds.add(i);
+
+    const roaring_set<unsigned int> unionSet = evens + thirds;
+    const roaring_set<unsigned int> intersectionSet = evens - thirds;
+    for (unsigned int i = 0; i < 300010; i++) {
+        assert(unionSet.contains(i) == (i < 300000 && (i % 2 == 0 || i % 3 == 0)));
+        assert(intersectionSet.contains(i) == (i < 300000 && i % 6 == 0));
+    }
+    assert(intersectionSet.size() == 50000);
+
+    roaring_set<unsigned int> shortRun, fewValues;
+    for (unsigned int i = 0; i < 10; i++)
+        shortRun.add(i);
+    assert(shortRun.run_optimize() == 1);
+    fewValues.add(100);
+    fewValues.add(200);
+    const roaring_set<unsigned int> smallUnion = shortRun + fewValues;
+    assert(smallUnion.size() == 12);
+    assert(smallUnion.bytes() < 1024); // torna array, niente bitmap da 8KB
+
+    assert((range - roaring_set<unsigned int>()).size() == 0);
+    assert((range + roaring_set<unsigned int>()) == range);
+
+    cout << "!! OPERATOR<<" << endl;
+    vector<int> values {5, -3, 70000, 2};
+    const roaring_set<int> small(values.begin(), values.end());
+    std::ostringstream os;
+    os << small;
+    assert(os.str() == "4 (-3) (2) (5) (70000)");
+
+    cout << "!!!! TEST_ROARING_SET SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Memory Usage
+*/
+void test_memory_usage(void) {
+    cout << "!!!! TEST_MEMORY_USAGE START" << endl;
+
+    cout << "!! MEMORY_USAGE" << endl;
+    IntSet intSet(10);
+    intSet.add(1);
+    intSet.add(2);
+    assert(intSet.memory_usage().buffer_bytes == 10 * sizeof(int));
+    assert(intSet.memory_usage().slack_bytes == 8 * sizeof(int));
+    assert(intSet.memory_usage().deep_bytes == 0);
+
+    set<std::string, equal_string> stringSet;
+    stringSet.add(std::string("c++"));
+    stringSet.add(std::string(1000, 'x'));
+    const set_memory_usage usage = stringSet.memory_usage(string_deep_size());
+    assert(usage.buffer_bytes == stringSet.capacity() * sizeof(std::string));
+    assert(usage.deep_bytes >= 1001);
+    assert(usage.total() == usage.buffer_bytes + usage.deep_bytes);
+
+    cout << "!! SET_REGISTRY" << endl;
+    set_registry &registry = set_registry::instance();
+    const std::size_t before = registry.size();
+    {
+        IntSet tracked1(100), tracked2(50);
+        tracked1.track("cache");
+        tracked2.track("cache");
+        intSet.track("altro");
+        assert(registry.size() == before + 3);
+
+        const IntSet copy(tracked1);
+        assert(registry.size() == before + 3);
+
+        tracked2 = copy;
+        assert(registry.size() == before + 3);
+
+        std::map<std::string, set_memory_usage> byTag = registry.usage_by_tag();
+        assert(byTag["cache"].buffer_bytes == 200 * sizeof(int));
+        assert(byTag["altro"].buffer_bytes == 10 * sizeof(int));
+
+        std::vector<set_registry::entry> entries = registry.entries();
+        bool found = false;
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].object == &intSet) {
+                assert(entries[i].tag == "altro");
+                assert(entries[i].usage.slack_bytes == 8 * sizeof(int));
+                found = true;
+            }
+        }
+        assert(found);
+    }
+    assert(registry.size() == before + 1);
+    intSet.untrack();
+    assert(registry.size() == before);
+
+    cout << "!!!! TEST_MEMORY_USAGE SUCCESS!" << endl;
+}
+
+/**
+  @brief Funzione di supporto che legge un file intero.
+*/
+std::string read_file(const std::string &file) {
+    std::ifstream in(file);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+/**
+  @brief Funzione che conta i file temporanei di write_atomic rimasti per un file.
+*/
+std::size_t count_temporaries(const std::string &file) {
+    std::size_t count = 0;
+    const std::string prefix = file + ".tmp";
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator("."))
+        if (entry.path().filename().string().compare(0, prefix.size(), prefix) == 0)
+            ++count;
+    return count;
+}
+
+/**
+  @brief Test Save Async
+*/
+void test_save_async(void) {
+    cout << "!!!! TEST_SAVE_ASYNC START" << endl;
+
+    cout << "!! SAVE_ASYNC" << endl;
+    set<std::string, equal_string> stringSet;
+    stringSet.add(std::string("best"));
+    stringSet.add(std::string("corso"));
+    stringSet.add(std::string("c++"));
+    const std::string expected = stream_output(stringSet);
+
+    std::future<void> done = save_async(stringSet, std::string("file_async.txt"));
+    stringSet.add(std::string("dopo"));
+    stringSet.remove(std::string("best"));
+    done.get();
+
+    assert(read_file("file_async.txt") == expected);
+    assert(count_temporaries("file_async.txt") == 0);
+
+    save(stringSet, std::string("file.txt"));
+    save_atomic(stringSet, std::string("file_async.txt"));
+    assert(read_file("file_async.txt") == read_file("file.txt"));
+
+    cout << "!! SAVE_ASYNC COW_SET" << endl;
+    cow_set<std::string, equal_string> cowSet(stringSet);
+    const std::string cowExpected = stream_output(cowSet);
+    done = save_async(cowSet, std::string("file_async.txt"));
+    cowSet.add(std::string("ancora"));
+    done.get();
+    assert(read_file("file_async.txt") == cowExpected);
+
+    cout << "!! SCRITTURE CONCORRENTI" << endl;
+    // la scrittura lenta finisce dopo quella veloce sullo stesso file:
+    // entrambe riescono e il file contiene la scrittura rinominata per ultima
+    std::atomic<bool> fastDone(false);
+    std::future<void> slow = std::async(std::launch::async, [&fastDone]() {
+        write_atomic("file_async.txt", [&fastDone](std::ostream &os) {
+            os << "AA";
+            while (!fastDone.load())
+                std::this_thread::yield();
+            os << "AA";
+        });
+    });
+    write_atomic("file_async.txt", [](std::ostream &os) {
+        os << "BB";
+    });
+    assert(read_file("file_async.txt") == "BB");
+    fastDone.store(true);
+    slow.get();
+    assert(read_file("file_async.txt") == "AAAA");
+    assert(count_temporaries("file_async.txt") == 0);
+
+    cout << "!! SAVE_ASYNC ERROR" << endl;
+    done = save_async(stringSet, std::string("cartella_inesistente/file.txt"));
+    try {
+        done.get();
+        assert(false);
+    } catch(const std::runtime_error &) {
+    }
+
+    std::remove("file_async.txt");
+
+    cout << "!!!! TEST_SAVE_ASYNC SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Set Generator
+*/
+void test_set_generator(void) {
+    cout << "!!!! TEST_SET_GENERATOR START" << endl;
+
+    IntSet lhs, rhs;
+    for (int i = 0; i < 10; i++)
+        lhs.add(i);
+    for (int i = 5; i < 15; i++)
+        rhs.add(i);
+
+    cout << "!! UNION_STREAM" << endl;
+    set_generator<int> unionGen = union_stream(lhs, rhs);
+    const IntSet unionSet(unionGen.begin(), unionGen.end());
+    assert(stream_output(unionSet) == stream_output(lhs + rhs));
+
+    cout << "!! INTERSECTION_STREAM" << endl;
+    set_generator<int> intersectionGen = intersection_stream(lhs, rhs);
+    const IntSet intersectionSet(intersectionGen.begin(), intersectionGen.end());
+    assert(stream_output(intersectionSet) == stream_output(lhs - rhs));
+
+    cout << "!! FILTER_OUT_STREAM" << endl;
+    set_generator<int> filterGen = filter_out_stream(lhs, is_bigger_than(6));
+    const IntSet filterSet(filterGen.begin(), filterGen.end());
+    assert(stream_output(filterSet) == stream_output(filter_out(lhs, is_bigger_than(6))));
+
+    cout << "!! CHAIN" << endl;
+    int count = 0;
+    for (int value : filter_out_stream(union_stream(lhs, rhs), is_bigger_than(11))) {
+        assert(value > 11);
+        count++;
+    }
+    assert(count == 3);
+
+    cout << "!! CANCEL" << endl;
+    count = 0;
+    {
+        set_generator<int> gen = union_stream(lhs, rhs);
+        for (set_generator<int>::const_iterator curr = gen.begin(); curr != gen.end() && count < 3; ++curr)
+            count++;
+    }
+    assert(count == 3);
+
+    cout << "!! EXCEPTION" << endl;
+    struct throwing {
+        bool operator()(int value) const {
+            if (value == 3)
+                throw std::runtime_error("predicato");
+            return true;
+        }
+    };
+    count = 0;
+    try {
+        for (int value : filter_out_stream(lhs, throwing())) {
+            (void)value;
+            count++;
+        }
+        assert(false);
+    } catch(const std::runtime_error &) {
+    }
+    assert(count == 3);
+
+    cout << "!! SAVE" << endl;
+    set<std::string, equal_string> words1, words2;
+    words1.add(std::string("best"));
+    words1.add(std::string("corso"));
+    words2.add(std::string("corso"));
+    words2.add(std::string("c++"));
+
+    assert(save(union_stream(words1, words2), std::string("file_stream.txt")) == 3);
+    save(words1 + words2, std::string("file.txt"));
+    assert(read_file("file_stream.txt") == read_file("file.txt"));
+
+    assert(save(intersection_stream(words1, set<std::string, equal_string>()), std::string("file_stream.txt")) == 0);
+    assert(read_file("file_stream.txt") == "0");
+    std::remove("file_stream.txt");
+
+    cout << "!!!! TEST_SET_GENERATOR SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Journaled Set
+*/
+void test_journaled_set(void) {
+    cout << "!!!! TEST_JOURNALED_SET START" << endl;
+
+    std::remove("journal.set");
+    std::remove("journal.set.log");
+
+    cout << "!! LOG" << endl;
+    {
+        journaled_set<int, equal_int> intSet("journal.set");
+        assert(intSet.size() == 0);
+        for (int i = 0; i < 10; i++)
+            assert(intSet.add(i));
+        assert(!intSet.add(3));
+        assert(intSet.remove(3));
+        assert(!intSet.remove(3));
+        assert(intSet.log_records() == 11);
+        intSet.sync();
+    }
+
+    cout << "!! RECOVERY" << endl;
+    {
+        journaled_set<int, equal_int> intSet("journal.set");
+        assert(intSet.size() == 9);
+        assert(!intSet.contains(3));
+        assert(intSet.contains(9));
+        assert(intSet.log_records() == 11);
+
+        cout << "!! COMPACT" << endl;
+        intSet.compact();
+        assert(intSet.log_records() == 0);
+        assert(read_file("journal.set.log").empty());
+        assert(intSet.add(42));
+        assert(intSet.remove(0));
+    }
+    {
+        const journaled_set<int, equal_int> intSet("journal.set");
+        assert(intSet.size() == 9);
+        assert(intSet.contains(42));
+        assert(!intSet.contains(0));
+        assert(intSet.log_records() == 2);
+    }
+
+    cout << "!! TORN LOG" << endl;
+    {
+        std::ofstream log("journal.set.log", std::ios::binary | std::ios::app);
+        log.write("A\x01\x02", 3);
+    }
+    {
+        journaled_set<int, equal_int> intSet("journal.set");
+        assert(intSet.size() == 9);
+        assert(intSet.log_records() == 0);
+        intSet.clear();
+    }
+    {
+        const journaled_set<int, equal_int> intSet("journal.set");
+        assert(intSet.size() == 0);
+    }
+
+    cout << "!! STRING" << endl;
+    std::remove("journal.set");
+    std::remove("journal.set.log");
+    {
+        journaled_set<std::string, equal_string> stringSet("journal.set");
+        stringSet.add(std::string("best"));
+        stringSet.add(std::string(""));
+        stringSet.compact();
+        stringSet.add(std::string("corso c++"));
+        stringSet.remove(std::string("best"));
+    }
+    {
+        const journaled_set<std::string, equal_string> stringSet("journal.set");
+        cout << "JOURNALED SET : " << stringSet << endl;
+        assert(stringSet.size() == 2);
+        assert(stringSet.contains(std::string("")));
+        assert(stringSet.contains(std::string("corso c++")));
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    cout << "!! SCRITTURA INTERROTTA" << endl;
+    {
+        journaled_set<std::string, equal_string> stringSet("journal.set");
+        stringSet.sync();
+        const std::uintmax_t logSize = std::filesystem::file_size("journal.set.log");
+
+        // limite sulla dimensione dei file: il record viene scritto solo in parte
+        rlimit unlimited, limited;
+        getrlimit(RLIMIT_FSIZE, &unlimited);
+        limited = unlimited;
+        limited.rlim_cur = logSize + 100;
+        std::signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &limited);
+        bool failed = false;
+        try {
+            stringSet.add(std::string(10000, 'x'));
+        } catch(const std::runtime_error &) {
+            failed = true;
+        }
+        setrlimit(RLIMIT_FSIZE, &unlimited);
+        std::signal(SIGXFSZ, SIG_DFL);
+
+        assert(failed);
+        assert(!stringSet.contains(std::string(10000, 'x')));
+        assert(std::filesystem::file_size("journal.set.log") == logSize);
+        assert(stringSet.add(std::string("dopo")));
+    }
+    {
+        const journaled_set<std::string, equal_string> stringSet("journal.set");
+        assert(stringSet.size() == 3);
+        assert(stringSet.contains(std::string("dopo")));
+        assert(stringSet.log_records() == 3);
+    }
+#endif
+
+    std::remove("journal.set");
+    std::remove("journal.set.log");
+
+    cout << "!!!! TEST_JOURNALED_SET SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Set Similarity
+*/
+void test_set_similarity(void) {
+    cout << "!!!! TEST_SET_SIMILARITY START" << endl;
+
+    IntSet lhs, rhs, empty;
+    for (int i = 0; i < 10; i++)
+        lhs.add(i);
+    for (int i = 5; i < 20; i++)
+        rhs.add(i);
+
+    cout << "!! INTERSECTION_SIZE" << endl;
+    assert(intersection_size(lhs, rhs) == (lhs - rhs).size());
+    assert(intersection_size(rhs, lhs) == 5);
+    assert(intersection_size(lhs, empty) == 0);
+
+    cout << "!! UNION_SIZE" << endl;
+    assert(union_size(lhs, rhs) == (lhs + rhs).size());
+    assert(union_size(lhs, empty) == 10);
+
+    cout << "!! JACCARD" << endl;
+    assert(jaccard(lhs, rhs) == 5.0 / 20.0);
+    assert(jaccard(lhs, lhs) == 1.0);
+    assert(jaccard(empty, empty) == 1.0);
+    assert(jaccard(lhs, empty) == 0.0);
+
+    cout << "!! INTERSECTS" << endl;
+    assert(intersects(lhs, rhs));
+    assert(!intersects(lhs, empty));
+    IntSet far;
+    far.add(100);
+    assert(!intersects(lhs, far));
+
+    cout << "!! MINHASH_SKETCH EXACT" << endl;
+    HashIntSet smallA(lhs.begin(), lhs.end()), smallB(rhs.begin(), rhs.end());
+    const minhash_sketch<> sketchA(smallA), sketchB(smallB);
+    assert(sketchA.exact() && sketchA.size() == 10);
+    assert(sketchA.estimate_size() == 10.0);
+    assert(jaccard(sketchA, sketchB) == jaccard(smallA, smallB));
+    assert(union_size(sketchA, sketchB) == 20.0);
+    assert(intersection_size(sketchA, sketchB) == 5.0);
+    assert(jaccard(minhash_sketch<>(), minhash_sketch<>()) == 1.0);
+
+    const minhash_sketch<10> fullSketch(smallA), overSketch(smallA + smallB);
+    assert(fullSketch.exact() && fullSketch.size() == 10);
+    assert(fullSketch.estimate_size() == 10.0);
+    assert(!overSketch.exact());
+    assert(!(fullSketch + minhash_sketch<10>(smallB)).exact());
+
+    cout << "!! MINHASH_SKETCH ESTIMATE" << endl;
+    std::vector<int> valuesA, valuesB;
+    for (int i = 0; i < 20000; i++)
+        valuesA.push_back(i);
+    for (int i = 10000; i < 40000; i++)
+        valuesB.push_back(i);
+    const HashIntSet bigA(parallel_policy(1), valuesA.begin(), valuesA.end());
+    const HashIntSet bigB(parallel_policy(1), valuesB.begin(), valuesB.end());
+    const minhash_sketch<> bigSketchA(bigA), bigSketchB(bigB);
+    assert(!bigSketchA.exact());
+
+    cout << "SIZE ~ " << bigSketchA.estimate_size() << " UNION ~ " << union_size(bigSketchA, bigSketchB)
+         << " JACCARD ~ " << jaccard(bigSketchA, bigSketchB) << endl;
+    assert(std::abs(bigSketchA.estimate_size() - 20000.0) < 20000.0 * 0.25);
+    assert(std::abs(union_size(bigSketchA, bigSketchB) - 40000.0) < 40000.0 * 0.25);
+    assert(std::abs(jaccard(bigSketchA, bigSketchB) - 0.25) < 0.1);
+    assert(std::abs(intersection_size(bigSketchA, bigSketchB) - 10000.0) < 10000.0 * 0.5);
+
+    cout << "!!!! TEST_SET_SIMILARITY SUCCESS!" << endl;
+}
+
+/**
+  @brief Test String Set
+*/
+void test_string_set(void) {
+    cout << "!!!! TEST_STRING_SET START" << endl;
+
+    cout << "!! ADD CONTAINS" << endl;
+    string_set stringSet;
+    assert(stringSet.add("https://example.com/item/1"));
+    assert(stringSet.add("https://example.com/item/2"));
+    assert(stringSet.add("https://example.com/item/12"));
+    assert(stringSet.add(""));
+    assert(stringSet.add("c"));
+    assert(!stringSet.add("https://example.com/item/1"));
+    assert(!stringSet.add(std::string("")));
+    assert(stringSet.size() == 5);
+    assert(stringSet.contains("https://example.com/item/12"));
+    assert(!stringSet.contains("https://example.com/item/3"));
+    assert(!stringSet.contains("https://example.com/ITEM/1"));
+    assert(stringSet.contains(""));
+
+    cout << "!! OUTPUT" << endl;
+    set<std::string, equal_string> reference;
+    for (string_set::const_iterator curr = stringSet.begin(); curr != stringSet.end(); ++curr)
+        reference.add(std::string(*curr));
+    assert(stream_output(stringSet) == stream_output(reference));
+    cout << "STRING SET : " << stringSet << endl;
+
+    save(stringSet, std::string("file_string_set.txt"));
+    save(reference, std::string("file.txt"));
+    assert(read_file("file_string_set.txt") == read_file("file.txt"));
+    std::remove("file_string_set.txt");
+
+    cout << "!! REMOVE" << endl;
+    assert(stringSet.remove("https://example.com/item/1"));
+    assert(!stringSet.remove("https://example.com/item/1"));
+    assert(stringSet[0] == "c");
+    assert(stringSet.remove("https://example.com/item/2"));
+    assert(stringSet.arena_size() == 28);
+    assert(stringSet.size() == 3);
+    assert(stringSet.contains("https://example.com/item/12"));
+    assert(stringSet.remove(""));
+    assert(stringSet.remove("c"));
+    assert(stringSet.contains("https://example.com/item/12"));
+
+    cout << "!! RANGE CTOR" << endl;
+    const std::vector<std::string> words = {"best", "corso", "c++", "corso"};
+    const string_set wordSet(words.begin(), words.end());
+    assert(wordSet.size() == 3);
+    const string_set wordSet2(wordSet);
+    assert(wordSet2 == wordSet);
+    assert(!(wordSet2 == stringSet));
+    assert(wordSet.memory_usage().deep_bytes >= 12);
+
+    cout << "!! OPERATOR== CON INDICE" << endl;
+    string_set forward, backward;
+    for (int i = 0; i < 1000; i++) {
+        forward.add("https://example.com/" + std::to_string(i));
+        backward.add("https://example.com/" + std::to_string(999 - i));
+    }
+    assert(forward.indexed() && backward.indexed());
+    assert(forward == backward);
+    assert(backward.remove("https://example.com/500"));
+    assert(backward.add("https://example.com/1000"));
+    assert(!(forward == backward));
+
+    cout << "!! INDICE" << endl;
+    string_set indexedSet(forward);
+    assert(indexedSet.indexed() && indexedSet == forward);
+    for (int i = 0; i < 1000; i++)
+        assert(indexedSet.contains("https://example.com/" + std::to_string(i)));
+    assert(!indexedSet.contains("https://example.com/1000"));
+    for (int i = 0; i < 990; i++)
+        assert(indexedSet.remove("https://example.com/" + std::to_string(i)));
+    assert(!indexedSet.indexed() && indexedSet.size() == 10);
+    for (int i = 990; i < 1000; i++)
+        assert(indexedSet.contains("https://example.com/" + std::to_string(i)));
+    assert(!indexedSet.contains("https://example.com/0"));
+
+    cout << "!!!! TEST_STRING_SET SUCCESS!" << endl;
+}
+
+/**
+  @brief Funzione di supporto che ritorna se un set usa l'indice hash.
+*/
+bool has_index(const HashIntSet &set) {
+    return set.memory_usage().buffer_bytes > set.capacity() * sizeof(int);
+}
+
+/**
+  @brief Test Adaptive Index
+*/
+void test_adaptive_index(void) {
+    cout << "!!!! TEST_ADAPTIVE_INDEX START" << endl;
+
+    cout << "!! SIZE THRESHOLD" << endl;
+    HashIntSet hashSet;
+    for (int i = 0; i < ADAPTIVE_INDEX_SIZE - 1; i++)
+        hashSet.add(i);
+    assert(!has_index(hashSet));
+    hashSet.add(ADAPTIVE_INDEX_SIZE - 1);
+    assert(has_index(hashSet));
+    for (int i = 0; i < ADAPTIVE_INDEX_SIZE; i++)
+        assert(hashSet.contains(i));
+    assert(!hashSet.contains(-1));
+    assert(!hashSet.add(5));
+    assert(hashSet.index_of(7) == 7);
+
+    cout << "!! HYSTERESIS" << endl;
+    for (int i = ADAPTIVE_INDEX_SIZE - 1; i >= ADAPTIVE_INDEX_MIN; i--)
+        assert(hashSet.remove(i));
+    assert(has_index(hashSet));
+    assert(hashSet.remove(0));
+    assert(!has_index(hashSet));
+    for (int i = 1; i < ADAPTIVE_INDEX_MIN; i++)
+        assert(hashSet.contains(i));
+
+    cout << "!! LOOKUP MIX" << endl;
+    HashIntSet mixSet;
+    for (int i = 0; i < 50; i++)
+        mixSet.add(i);
+    assert(!has_index(mixSet));
+    for (int i = 0; i < 49; i++)
+        assert(mixSet.contains(i));
+    assert(!has_index(mixSet));
+    // la ricerca che porta il contatore alla size costruisce l'indice
+    assert(mixSet.contains(49));
+    assert(has_index(mixSet));
+    mixSet.add(50);
+    assert(has_index(mixSet));
+    assert(mixSet.contains(50));
+
+    cout << "!! LOOKUP MIX CONCORRENTE" << endl;
+    HashIntSet sharedSet;
+    for (int i = 0; i < 100; i++)
+        sharedSet.add(i);
+    assert(!sharedSet.indexed());
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.push_back(std::thread([&sharedSet]() {
+            for (int i = 0; i < 1000; i++)
+                assert(sharedSet.contains(i % 100) && !sharedSet.contains(100 + i));
+        }));
+    }
+    for (std::size_t t = 0; t < readers.size(); t++)
+        readers[t].join();
+    assert(sharedSet.indexed());
+
+    cout << "!! CRESCITA CON INDICE" << endl;
+    HashIntSet grownSet;
+    for (int i = 0; i < 1000; i++)
+        grownSet.add(i);
+    assert(grownSet.capacity() == 1024); // raddoppio, non passi di MAX_RESIZE
+    vector<int> bulkValues(1000);
+    for (int i = 0; i < 1000; i++)
+        bulkValues[i] = i;
+    HashIntSet bulkSet(parallel_policy(1), bulkValues.begin(), bulkValues.end());
+    assert(bulkSet.indexed() && bulkSet.capacity() == 1000);
+    bulkSet.add(1000);
+    assert(bulkSet.capacity() == 2000 && bulkSet.contains(1000));
+
+    IntSet plainSet;
+    for (int i = 0; i < 300; i++)
+        plainSet.add(i);
+    assert(plainSet.memory_usage().buffer_bytes == plainSet.capacity() * sizeof(int));
+
+    cout << "!! HEADER" << endl;
+    // con null_hash: array, capacità, size, flag del registro e ricerca congelata
+    struct compact_header {
+        int *array;
+        unsigned int capacity, size;
+        bool tracked;
+        void (*frozen_find)();
+    };
+    static_assert(sizeof(IntSet) == sizeof(compact_header), "header del set con null_hash non compatto");
+    static_assert(sizeof(HashIntSet) > sizeof(IntSet), "il set con Hash ha indice e digest");
+
+    cout << "!! COPY ERASE_IF" << endl;
+    const HashIntSet copySet(mixSet);
+    assert(has_index(copySet));
+    assert(copySet == mixSet);
+    assert(mixSet.erase_if(is_bigger_than(29)) == 21);
+    assert(has_index(mixSet));
+    for (int i = 0; i < 51; i++)
+        assert(mixSet.contains(i) == (i < 30));
+
+    cout << "!! RANDOM OPS" << endl;
+    HashIntSet randomSet;
+    std::vector<bool> reference(600, false);
+    unsigned int state = 12345;
+    int count = 0;
+    for (int op = 0; op < 50000; op++) {
+        state = state * 1103515245u + 12345u;
+        const int value = static_cast<int>((state >> 8) % 600);
+        if ((state >> 4) % 3 == 0) {
+            assert(randomSet.remove(value) == reference[value]);
+            count -= reference[value] ? 1 : 0;
+            reference[value] = false;
+        } else {
+            assert(randomSet.add(value) == !reference[value]);
+            count += reference[value] ? 0 : 1;
+            reference[value] = true;
+        }
+        assert(randomSet.contains(value) == reference[value]);
+        assert(static_cast<int>(randomSet.size()) == count);
+    }
+    for (int i = 0; i < 600; i++)
+        assert(randomSet.contains(i) == reference[i]);
+    assert(has_index(randomSet));
+
+    cout << "!!!! TEST_ADAPTIVE_INDEX SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Freeze
+*/
+void test_freeze(void) {
+    cout << "!!!! TEST_FREEZE START" << endl;
+
+    cout << "!! FREEZE" << endl;
+    IntSet intSet;
+    for (int i = 0; i < 100; i++)
+        intSet.add((i * 37) % 101);
+    const IntSet reference(intSet);
+    intSet.freeze();
+    assert(intSet.frozen());
+    assert(intSet.size() == 100);
+    assert(intSet == reference);
+    for (int i = 0; i < 101; i++) {
+        assert(intSet.contains(i) == reference.contains(i));
+        if (intSet.contains(i))
+            assert(intSet[intSet.index_of(i)] == i);
+    }
+    assert(!intSet.contains(-1));
+    assert(!intSet.contains(1000));
+
+    cout << "!! ITERATION" << endl;
+    long sum = 0, referenceSum = 0;
+    for (IntSet::const_iterator curr = intSet.begin(); curr != intSet.end(); ++curr)
+        sum += *curr;
+    for (unsigned int i = 0; i < reference.size(); i++)
+        referenceSum += reference[i];
+    assert(sum == referenceSum);
+
+    cout << "!! AUTO THAW" << endl;
+    assert(!intSet.add(5));
+    assert(intSet.frozen());
+    assert(!intSet.remove(-5));
+    assert(intSet.frozen());
+    assert(intSet.add(500));
+    assert(!intSet.frozen());
+    assert(intSet.contains(500) && intSet.contains(5));
+    intSet.freeze<std::greater<int> >();
+    assert(intSet.contains(500) && intSet.contains(5) && !intSet.contains(501));
+    assert(intSet.remove(5));
+    assert(!intSet.frozen());
+    assert(!intSet.contains(5));
+
+    cout << "!! THAW" << endl;
+    HashIntSet hashSet;
+    for (int i = 0; i < 1000; i++)
+        hashSet.add(i * 3);
+    hashSet.freeze();
+    assert(hashSet.memory_usage().buffer_bytes == hashSet.capacity() * sizeof(int));
+    for (int i = 0; i < 3000; i++)
+        assert(hashSet.contains(i) == (i % 3 == 0));
+    const HashIntSet frozenCopy(hashSet);
+    assert(frozenCopy.frozen() && frozenCopy.contains(2997));
+    hashSet.thaw();
+    assert(!hashSet.frozen());
+    assert(hashSet.memory_usage().buffer_bytes > hashSet.capacity() * sizeof(int));
+    assert(hashSet.contains(2997) && !hashSet.contains(2998));
+    assert(hashSet.erase_if(is_bigger_than(1500)) == 499);
+    assert(hashSet.size() == 501);
+
+    cout << "!! STRING" << endl;
+    set<std::string, equal_string> stringSet;
+    stringSet.add(std::string("corso"));
+    stringSet.add(std::string("best"));
+    stringSet.add(std::string("c++"));
+    stringSet.freeze();
+    assert(stringSet.contains(std::string("best")));
+    assert(!stringSet.contains(std::string("bes")));
+    cout << "FROZEN SET : " << stringSet << endl;
+
+    IntSet emptySet;
+    emptySet.freeze();
+    assert(!emptySet.contains(0));
+    assert(emptySet.add(0));
+    assert(emptySet.contains(0));
+
+    cout << "!!!! TEST_FREEZE SUCCESS!" << endl;
+}
+
+/**
+  @brief Test Buffered Inserter
+*/
+void test_buffered_inserter(void) {
+    cout << "!!!! TEST_BUFFERED_INSERTER START" << endl;
+
+    cout << "!! BATCH" << endl;
+    locked_set<int, equal_int, hash_int> shared;
+    {
+        buffered_inserter<int, equal_int, hash_int> inserter(shared, 4);
+        assert(inserter.add(1));
+        assert(!inserter.add(1));
+        assert(inserter.add(2));
+        assert(inserter.add(3));
+        assert(inserter.pending() == 3);
+        assert(shared.size() == 0 && shared.epoch() == 0);
+        assert(inserter.add(4));
+        assert(inserter.pending() == 0);
+        assert(shared.size() == 4 && shared.epoch() == 1);
+
+        cout << "!! FLUSH" << endl;
+        assert(inserter.add(5));
+        assert(!shared.contains(5));
+        assert(inserter.flush() == 2);
+        assert(shared.contains(5));
+        assert(inserter.flush() == 2);
+        inserter.add(6);
+    }
+    assert(shared.contains(6) && shared.epoch() == 3);
+
+    cout << "!! TIMER" << endl;
+    {
+        buffered_inserter<int, equal_int, hash_int> inserter(shared, 1000, std::chrono::milliseconds(1));
+        inserter.add(7);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        assert(!shared.contains(7));
+        inserter.add(8);
+        assert(inserter.pending() == 0);
+        assert(shared.contains(7) && shared.contains(8));
+    }
+    {
+        buffered_inserter<int, equal_int, hash_int> inserter(shared, 1000, std::chrono::milliseconds(50));
+
+        // anche un duplicato controlla il limite di tempo
+        assert(inserter.add(9));
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        assert(!inserter.add(9));
+        assert(inserter.pending() == 0 && shared.contains(9));
+
+        // thread inattivo: flush_if_due
+        assert(inserter.add(10));
+        assert(!inserter.flush_if_due());
+        std::this_thread::sleep_for(std::chrono::milliseconds(60));
+        assert(inserter.flush_if_due());
+        assert(inserter.pending() == 0 && shared.contains(10));
+        assert(!inserter.flush_if_due());
+    }
+
+    cout << "!! ERASE_ALL" << endl;
+    HashIntSet buffer(ADAPTIVE_INDEX_SIZE);
+    for (int i = 0; i < ADAPTIVE_INDEX_SIZE; i++)
+        buffer.add(i);
+    assert(buffer.indexed());
+    buffer.erase_all();
+    assert(buffer.size() == 0 && buffer.capacity() == ADAPTIVE_INDEX_SIZE && !buffer.indexed());
+    assert(!buffer.contains(5));
+    assert(buffer.add(5) && buffer.contains(5) && !buffer.contains(6));
+    assert(buffer.size() == 1 && buffer.capacity() == ADAPTIVE_INDEX_SIZE);
+
+    cout << "!! THREADS" << endl;
+    locked_set<int, equal_int, hash_int> ingest;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.push_back(std::thread([&ingest, t]() {
+            buffered_inserter<int, equal_int, hash_int> inserter(ingest, 64);
+            for (int i = 0; i < 20000; i++)
+                inserter.add((i / 10 * 7 + t) % 1000);
+        }));
+    }
+    for (std::size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    assert(ingest.size() == 1000);
+    assert(ingest.epoch() <= 4 * (20000 / 10 / 64 + 1));
+    const HashIntSet result = ingest.snapshot();
+    for (int i = 0; i < 1000; i++)
+        assert(result.contains(i));
+
+    cout << "!!!! TEST_BUFFERED_INSERTER SUCCESS!" << endl;
+}
+
 int main() {
 
     test_base();
@@ -657,5 +2128,43 @@ int main() {
 
     test_set_capacity();
 
+    test_digest();
+
+    test_frozen_set();
+
+    test_projected_set();
+
+    test_erase_if();
+
+    test_cow_set();
+
+    test_size_type_storage();
+
+    test_parallel_ctor();
+
+    test_union_intersect_all();
+
+    test_buffered_output();
+
+    test_roaring_set();
+
+    test_memory_usage();
+
+    test_save_async();
+
+    test_set_generator();
+
+    test_journaled_set();
+
+    test_set_similarity();
+
+    test_string_set();
+
+    test_adaptive_index();
+
+    test_freeze();
+
+    test_buffered_inserter();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,277 @@
+/**
+  @file projected_set.hpp
+
+  @brief File header della classe projected_set templata
+
+  File di dichiarazioni/definizioni della classe projected_set, un set di
+  record identificati da una chiave estratta tramite proiezione
+*/
+
+#ifndef PROJECTED_SET_HPP
+#define PROJECTED_SET_HPP
+
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <type_traits> // std::decay
+#include <utility> // std::declval
+#include "set.hpp"
+
+/**
+  @brief classe set di record con layout struct-of-arrays
+
+  La classe implementa un set di record T in cui l'unicità è data dalla
+  chiave KeyOf()(record). Le chiavi sono tenute in un set denso e contiguo,
+  i record in un array parallelo: scansioni, confronti e hash toccano solo
+  le chiavi e il record viene letto solo quando trovato (in pratica una
+  flat map costruita sul set). Equal e Hash lavorano sulle chiavi.
+*/
+template <typename T, typename KeyOf, typename Equal, typename Hash = null_hash>
+class projected_set {
+public:
+    /**
+        TypeDef del tipo contenuto nel set e della chiave estratta
+    */
+    typedef T value_type;
+    typedef typename std::decay<decltype(std::declval<KeyOf>()(std::declval<const T&>()))>::type key_type;
+    typedef set<key_type, Equal, Hash> key_set;
+    typedef typename key_set::size_type size_type;
+
+    /**
+        TypeDef dell'iteratore Costante sui record
+    */
+    typedef const value_type* const_iterator;
+private:
+    KeyOf _key_of;
+    key_set _keys;
+    value_type* _values; // _values[i] è il record con chiave _keys[i]
+    size_type _values_capacity;
+
+    /**
+        @brief Funzione di supporto che porta la capacità dell'array dei
+        record alla capacità del set delle chiavi.
+
+        @param count numero di record validi da conservare
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void sync_capacity(size_type count) {
+        const size_type capacity = _keys.capacity();
+        if (capacity == _values_capacity)
+            return;
+
+        value_type* tmp = nullptr;
+        if (capacity != 0) {
+            tmp = new value_type[capacity];
+            try {
+                for (size_type i = 0; i < count; ++i)
+                    tmp[i] = _values[i];
+            } catch(...) {
+                delete[] tmp;
+                throw;
+            }
+        }
+
+        delete[] _values;
+        _values = tmp;
+        _values_capacity = capacity;
+    }
+
+public:
+    /**
+        @brief Costruttore di default.
+
+        @post size() == 0
+    */
+    projected_set() : _values(nullptr), _values_capacity(0) {}
+
+    /**
+        @brief Copy constructor.
+
+        @param other set da copiare
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    projected_set(const projected_set &other) : _keys(other._keys), _values(nullptr), _values_capacity(0) {
+        try {
+            _values = new value_type[_keys.capacity()];
+            _values_capacity = _keys.capacity();
+
+            for (size_type i = 0; i < _keys.size(); ++i)
+                _values[i] = other._values[i];
+        } catch(...) {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+        @brief Operatore di assegnamento.
+
+        @param other set da copiare
+
+        @return reference al set this
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    projected_set& operator=(const projected_set &other) {
+        if (this != &other) {
+            projected_set tmp(other);
+            this->swap(tmp);
+        }
+
+        return *this;
+    }
+
+    /**
+        @brief Distruttore e dealloca la memoria allocata.
+    */
+    ~projected_set() {
+        clear();
+    }
+
+    /**
+        @brief Funzione che svuota il set e dealloca la memoria allocata.
+
+        @post size() == 0
+    */
+    void clear(void) {
+        _keys.clear();
+        delete[] _values;
+        _values = nullptr;
+        _values_capacity = 0;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero dei record del set.
+
+        @return numero dei record nel set
+    */
+    size_type size(void) const {
+        return _keys.size();
+    }
+
+    /**
+        @brief Funzione che ritorna il set delle chiavi, nello stesso
+        ordine dei record.
+
+        @return reference costante al set delle chiavi
+    */
+    const key_set& keys(void) const {
+        return _keys;
+    }
+
+    /**
+        @brief Funzione scambia lo stato tra l'istanza corrente
+        e quella passata come parametro.
+
+        @param other set con cui scambiare lo stato
+    */
+    void swap(projected_set &other) {
+        _keys.swap(other._keys);
+        std::swap(_values, other._values);
+        std::swap(_values_capacity, other._values_capacity);
+        std::swap(_key_of, other._key_of);
+    }
+
+    /**
+        @brief Operatore getter di un record del set.
+
+        @param index posizione del record da leggere
+        @return reference costante al record da leggere
+
+        @pre index < size()
+    */
+    const value_type& operator[](const size_type index) const {
+        assert(index < _keys.size());
+        return _values[index];
+    }
+
+    /**
+        @brief Funzione che aggiunge un record al set se la sua chiave
+        non è già presente.
+
+        @param value reference costante del record da aggiungere
+
+        @return true se aggiunto con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool add(const value_type &value) {
+        if (!_keys.add(_key_of(value)))
+            return false;
+
+        try {
+            sync_capacity(_keys.size() - 1);
+            _values[_keys.size() - 1] = value;
+        } catch(...) {
+            _keys.remove_at(_keys.size() - 1);
+            throw;
+        }
+        return true;
+    }
+
+    /**
+        @brief Funzione che rimuove il record con una chiave.
+
+        @param key reference costante della chiave da rimuovere
+
+        @return true se rimosso con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool remove(const key_type &key) {
+        const size_type index = _keys.index_of(key);
+        if (index == _keys.size())
+            return false;
+
+        std::swap(_values[index], _values[_keys.size() - 1]);
+        _keys.remove_at(index);
+        sync_capacity(_keys.size());
+        return true;
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di una chiave.
+
+        @param key reference costante della chiave da controllare
+
+        @return true se la chiave è presente nel set, false altrimenti
+    */
+    bool contains(const key_type &key) const {
+        return _keys.contains(key);
+    }
+
+    /**
+        @brief Funzione che cerca il record con una chiave.
+
+        @param key reference costante della chiave da cercare
+
+        @return puntatore al record, nullptr se la chiave non è presente
+    */
+    const value_type* find(const key_type &key) const {
+        const size_type index = _keys.index_of(key);
+        if (index == _keys.size())
+            return nullptr;
+        return _values + index;
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore all'inizio dei record.
+
+        @return iteratore all'inizio dei record
+    */
+    const_iterator begin(void) const {
+        return _values;
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore alla fine dei record.
+
+        @return iteratore alla fine dei record
+    */
+    const_iterator end(void) const {
+        return _values + _keys.size();
+    }
+};
+
+#endif // PROJECTED_SET_HPP
@@ -0,0 +1,942 @@
+/**
+  @file roaring_set.hpp
+
+  @brief File header della classe roaring_set templata
+
+  File di dichiarazioni/definizioni della classe roaring_set, un set di
+  interi compresso a blocchi (stile Roaring bitmap)
+*/
+
+#ifndef ROARING_SET_HPP
+#define ROARING_SET_HPP
+
+#include <algorithm> // std::lower_bound, std::set_union, std::set_intersection
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint16_t, std::uint32_t, std::uint64_t
+#include <iostream> // std::ostream
+#include <iterator> // std::forward_iterator_tag, std::back_inserter
+#include <type_traits> // std::is_integral, std::is_signed
+#include <vector> // std::vector
+
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_BITMAP_WORDS 1024
+
+/**
+    @brief Funzione che conta i bit a 1 di una parola.
+
+    @param word parola da contare
+
+    @return numero di bit a 1
+*/
+inline std::uint32_t roaring_popcount(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::uint32_t>(__builtin_popcountll(word));
+#else
+    std::uint32_t count = 0;
+    for (; word != 0; word &= word - 1)
+        ++count;
+    return count;
+#endif
+}
+
+/**
+    @brief Funzione che ritorna l'indice del bit a 1 meno significativo.
+
+    @param word parola diversa da 0
+
+    @return indice del bit
+*/
+inline std::uint32_t roaring_ctz(std::uint64_t word) {
+    assert(word != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::uint32_t>(__builtin_ctzll(word));
+#else
+    std::uint32_t index = 0;
+    for (; (word & 1) == 0; word >>= 1)
+        ++index;
+    return index;
+#endif
+}
+
+/**
+  @brief Classe di supporto che contiene i valori di un blocco di 2^16 interi.
+
+  Il blocco cambia rappresentazione in base al contenuto:
+  - array: valori ordinati, fino a ROARING_ARRAY_MAX valori;
+  - bitmap: un bit per valore possibile (8KB), oltre ROARING_ARRAY_MAX valori;
+  - run: coppie (inizio, lunghezza - 1) ordinate, solo tramite run_optimize.
+*/
+class roaring_container {
+public:
+    enum kind_type { array_kind, bitmap_kind, run_kind };
+
+    /**
+        Valore ritornato da next quando non ci sono altri valori
+    */
+    static const std::uint32_t end_value = 0x10000;
+private:
+    std::uint16_t _key; // 16 bit alti dei valori del blocco
+    kind_type _kind;
+    std::uint32_t _card;
+    std::vector<std::uint16_t> _values; // array: valori, run: coppie inizio/lunghezza - 1
+    std::vector<std::uint64_t> _words; // bitmap
+
+    std::size_t runs(void) const {
+        return _values.size() / 2;
+    }
+
+    std::uint32_t run_start(std::size_t run) const {
+        return _values[2 * run];
+    }
+
+    std::uint32_t run_last(std::size_t run) const {
+        return static_cast<std::uint32_t>(_values[2 * run]) + _values[2 * run + 1];
+    }
+
+    /**
+        @brief Funzione di supporto che ritorna la prima run che finisce
+        dopo o su un valore.
+
+        @param low valore da cercare
+
+        @return indice della run, runs() se non esiste
+    */
+    std::size_t run_search(std::uint32_t low) const {
+        std::size_t first = 0;
+        std::size_t count = runs();
+        while (count > 0) {
+            const std::size_t half = count / 2;
+            if (run_last(first + half) < low) {
+                first += half + 1;
+                count -= half + 1;
+            } else {
+                count = half;
+            }
+        }
+        return first;
+    }
+
+    /**
+        @brief Funzione di supporto che conta le run della bitmap.
+
+        @return numero di run
+    */
+    std::size_t bitmap_runs(void) const {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < ROARING_BITMAP_WORDS; ++i) {
+            const std::uint64_t word = _words[i];
+            const std::uint64_t previous = i == 0 ? 0 : _words[i - 1] >> 63;
+            count += roaring_popcount(word & ~((word << 1) | previous));
+        }
+        return count;
+    }
+
+public:
+    /**
+        @brief Costruttore di un blocco vuoto in rappresentazione array.
+
+        @param key 16 bit alti dei valori del blocco
+    */
+    explicit roaring_container(std::uint16_t key) : _key(key), _kind(array_kind), _card(0) {}
+
+    /**
+        @brief Funzione che ritorna i 16 bit alti dei valori del blocco.
+
+        @return chiave del blocco
+    */
+    std::uint16_t key(void) const {
+        return _key;
+    }
+
+    /**
+        @brief Funzione che ritorna la rappresentazione del blocco.
+
+        @return rappresentazione del blocco
+    */
+    kind_type kind(void) const {
+        return _kind;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero di valori del blocco.
+
+        @return numero di valori
+    */
+    std::uint32_t cardinality(void) const {
+        return _card;
+    }
+
+    /**
+        @brief Funzione che ritorna i byte usati dai valori del blocco.
+
+        @return byte usati
+    */
+    std::size_t bytes(void) const {
+        return _values.capacity() * sizeof(std::uint16_t) + _words.capacity() * sizeof(std::uint64_t);
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di un valore.
+
+        @param low 16 bit bassi del valore
+
+        @return true se il valore è presente, false altrimenti
+    */
+    bool contains(std::uint16_t low) const {
+        switch (_kind) {
+        case bitmap_kind:
+            return (_words[low >> 6] >> (low & 63)) & 1;
+        case array_kind:
+            return std::binary_search(_values.begin(), _values.end(), low);
+        default: {
+            const std::size_t run = run_search(low);
+            return run < runs() && run_start(run) <= low;
+        }
+        }
+    }
+
+    /**
+        @brief Funzione che ritorna il primo valore maggiore o uguale ad un valore.
+
+        @param from valore da cui cercare
+
+        @return 16 bit bassi del valore trovato, end_value se non esiste
+    */
+    std::uint32_t next(std::uint32_t from) const {
+        if (from >= end_value)
+            return end_value;
+
+        switch (_kind) {
+        case bitmap_kind: {
+            std::size_t i = from >> 6;
+            std::uint64_t word = _words[i] & (~std::uint64_t(0) << (from & 63));
+            while (word == 0) {
+                if (++i == ROARING_BITMAP_WORDS)
+                    return end_value;
+                word = _words[i];
+            }
+            return static_cast<std::uint32_t>(i * 64 + roaring_ctz(word));
+        }
+        case array_kind: {
+            std::vector<std::uint16_t>::const_iterator found =
+                std::lower_bound(_values.begin(), _values.end(), from);
+            return found == _values.end() ? end_value : *found;
+        }
+        default: {
+            const std::size_t run = run_search(from);
+            if (run == runs())
+                return end_value;
+            return std::max(run_start(run), from);
+        }
+        }
+    }
+
+    /**
+        @brief Funzione che converte il blocco in bitmap.
+    */
+    void to_bitmap(void) {
+        if (_kind == bitmap_kind)
+            return;
+
+        std::vector<std::uint64_t> words(ROARING_BITMAP_WORDS, 0);
+        if (_kind == array_kind) {
+            for (std::size_t i = 0; i < _values.size(); ++i)
+                words[_values[i] >> 6] |= std::uint64_t(1) << (_values[i] & 63);
+        } else {
+            for (std::size_t run = 0; run < runs(); ++run) {
+                for (std::uint32_t v = run_start(run); v <= run_last(run); ++v)
+                    words[v >> 6] |= std::uint64_t(1) << (v & 63);
+            }
+        }
+
+        _words.swap(words);
+        std::vector<std::uint16_t>().swap(_values);
+        _kind = bitmap_kind;
+    }
+
+    /**
+        @brief Funzione che converte il blocco in array.
+
+        @pre cardinality() <= ROARING_ARRAY_MAX
+    */
+    void to_array(void) {
+        if (_kind == array_kind)
+            return;
+        assert(_card <= ROARING_ARRAY_MAX);
+
+        std::vector<std::uint16_t> values;
+        values.reserve(_card);
+        for (std::uint32_t v = next(0); v != end_value; v = next(v + 1))
+            values.push_back(static_cast<std::uint16_t>(v));
+
+        _values.swap(values);
+        std::vector<std::uint64_t>().swap(_words);
+        _kind = array_kind;
+    }
+
+    /**
+        @brief Funzione che sceglie tra array e bitmap in base al numero di valori.
+    */
+    void normalize(void) {
+        if (_card <= ROARING_ARRAY_MAX)
+            to_array();
+        else
+            to_bitmap();
+    }
+
+    /**
+        @brief Funzione che converte il blocco in run se è la
+        rappresentazione più compatta, altrimenti in array o bitmap.
+
+        @return true se il blocco è ora in rappresentazione run
+    */
+    bool run_optimize(void) {
+        if (_kind == run_kind)
+            normalize();
+
+        std::size_t count = 0;
+        if (_kind == bitmap_kind) {
+            count = bitmap_runs();
+        } else {
+            for (std::size_t i = 0; i < _values.size(); ++i) {
+                if (i == 0 || _values[i] != _values[i - 1] + 1)
+                    ++count;
+            }
+        }
+
+        const std::size_t run_bytes = 4 * count;
+        const std::size_t other_bytes = _kind == bitmap_kind ? 8 * ROARING_BITMAP_WORDS : 2 * _card;
+        if (run_bytes >= other_bytes)
+            return false;
+
+        std::vector<std::uint16_t> values;
+        values.reserve(2 * count);
+        for (std::uint32_t v = next(0); v != end_value;) {
+            std::uint32_t last = v;
+            std::uint32_t following = next(v + 1);
+            while (following != end_value && following == last + 1) {
+                last = following;
+                following = next(last + 1);
+            }
+            values.push_back(static_cast<std::uint16_t>(v));
+            values.push_back(static_cast<std::uint16_t>(last - v));
+            v = following;
+        }
+
+        _values.swap(values);
+        std::vector<std::uint64_t>().swap(_words);
+        _kind = run_kind;
+        return true;
+    }
+
+    /**
+        @brief Funzione che aggiunge un valore.
+
+        @param low 16 bit bassi del valore
+
+        @return true se aggiunto, false se già presente
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool add(std::uint16_t low) {
+        if (_kind == run_kind) {
+            if (contains(low))
+                return false;
+            normalize();
+        }
+
+        if (_kind == bitmap_kind) {
+            std::uint64_t &word = _words[low >> 6];
+            const std::uint64_t bit = std::uint64_t(1) << (low & 63);
+            if (word & bit)
+                return false;
+            word |= bit;
+            ++_card;
+            return true;
+        }
+
+        std::vector<std::uint16_t>::iterator found = std::lower_bound(_values.begin(), _values.end(), low);
+        if (found != _values.end() && *found == low)
+            return false;
+        _values.insert(found, low);
+        ++_card;
+        if (_card > ROARING_ARRAY_MAX)
+            to_bitmap();
+        return true;
+    }
+
+    /**
+        @brief Funzione che rimuove un valore.
+
+        @param low 16 bit bassi del valore
+
+        @return true se rimosso, false se non presente
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool remove(std::uint16_t low) {
+        if (!contains(low))
+            return false;
+
+        if (_kind == run_kind)
+            normalize();
+
+        if (_kind == bitmap_kind) {
+            _words[low >> 6] &= ~(std::uint64_t(1) << (low & 63));
+            if (--_card <= ROARING_ARRAY_MAX)
+                to_array();
+        } else {
+            _values.erase(std::lower_bound(_values.begin(), _values.end(), low));
+            --_card;
+        }
+        return true;
+    }
+
+    /**
+        @brief Funzione che unisce un altro blocco con la stessa chiave.
+        Tra bitmap l'unione è un OR parola per parola; il risultato torna
+        array se ha pochi valori.
+
+        @param other blocco da unire
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void unite(const roaring_container &other) {
+        if (_kind == array_kind && other._kind == array_kind) {
+            std::vector<std::uint16_t> values;
+            values.reserve(_values.size() + other._values.size());
+            std::set_union(_values.begin(), _values.end(), other._values.begin(), other._values.end(),
+                           std::back_inserter(values));
+            _values.swap(values);
+            _card = static_cast<std::uint32_t>(_values.size());
+            if (_card > ROARING_ARRAY_MAX)
+                to_bitmap();
+            return;
+        }
+
+        roaring_container tmp(other);
+        tmp.to_bitmap();
+        to_bitmap();
+
+        std::uint32_t card = 0;
+        for (std::size_t i = 0; i < ROARING_BITMAP_WORDS; ++i) {
+            _words[i] |= tmp._words[i];
+            card += roaring_popcount(_words[i]);
+        }
+        _card = card;
+        normalize();
+    }
+
+    /**
+        @brief Funzione che interseca con un altro blocco con la stessa chiave.
+        Tra bitmap l'intersezione è un AND parola per parola.
+
+        @param other blocco da intersecare
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void intersect(const roaring_container &other) {
+        if (_kind == array_kind || other._kind == array_kind) {
+            const roaring_container &small = _kind == array_kind ? *this : other;
+            const roaring_container &big = _kind == array_kind ? other : *this;
+
+            std::vector<std::uint16_t> values;
+            for (std::size_t i = 0; i < small._values.size(); ++i) {
+                if (big.contains(small._values[i]))
+                    values.push_back(small._values[i]);
+            }
+
+            _values.swap(values);
+            std::vector<std::uint64_t>().swap(_words);
+            _kind = array_kind;
+            _card = static_cast<std::uint32_t>(_values.size());
+            return;
+        }
+
+        roaring_container tmp(other);
+        tmp.to_bitmap();
+        to_bitmap();
+
+        std::uint32_t card = 0;
+        for (std::size_t i = 0; i < ROARING_BITMAP_WORDS; ++i) {
+            _words[i] &= tmp._words[i];
+            card += roaring_popcount(_words[i]);
+        }
+        _card = card;
+        normalize();
+    }
+
+    /**
+        @brief Funzione che controlla se due blocchi contengono gli stessi valori.
+
+        @param other blocco da controllare
+
+        @return true se i blocchi contengono gli stessi valori
+    */
+    bool operator==(const roaring_container &other) const {
+        if (_key != other._key || _card != other._card)
+            return false;
+        if (_kind == other._kind && _kind != bitmap_kind)
+            return _values == other._values;
+        if (_kind == bitmap_kind && other._kind == bitmap_kind)
+            return _words == other._words;
+
+        for (std::uint32_t v = next(0); v != end_value; v = next(v + 1)) {
+            if (!other.contains(static_cast<std::uint16_t>(v)))
+                return false;
+        }
+        return true;
+    }
+};
+
+/**
+  @brief classe set di interi compressa
+
+  La classe implementa un set di interi T (al massimo a 32 bit) con la stessa
+  interfaccia di set (add/remove/contains/iterazione). I valori sono divisi in
+  blocchi di 2^16 per i 16 bit alti e ogni blocco sceglie tra array ordinato,
+  bitmap e run (vedi roaring_container). Per range densi usa circa un bit per
+  elemento, contains costa poche istruzioni e unione/intersezione lavorano
+  parola per parola (il compilatore vettorizza i cicli con SIMD).
+  L'iterazione avviene in ordine crescente.
+*/
+template <typename T>
+class roaring_set {
+public:
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 4, "roaring_set supporta solo interi fino a 32 bit");
+
+    /**
+        TypeDef del tipo contenuto nel set
+    */
+    typedef T value_type;
+    typedef std::size_t size_type;
+private:
+    std::vector<roaring_container> _containers; // ordinati per chiave
+    std::vector<std::uint16_t> _keys; // _keys[i] == _containers[i].key(), contigue per la ricerca
+    size_type _size;
+
+    /**
+        @brief Funzione di supporto che porta un valore in un intero senza
+        segno che ne preserva l'ordine.
+    */
+    static std::uint32_t encode(value_type value) {
+        if (std::is_signed<T>::value)
+            return static_cast<std::uint32_t>(static_cast<std::int32_t>(value)) ^ 0x80000000u;
+        return static_cast<std::uint32_t>(value);
+    }
+
+    /**
+        @brief Funzione di supporto inversa di encode.
+    */
+    static value_type decode(std::uint32_t code) {
+        if (std::is_signed<T>::value)
+            return static_cast<value_type>(static_cast<std::int32_t>(code ^ 0x80000000u));
+        return static_cast<value_type>(code);
+    }
+
+    /**
+        @brief Funzione di supporto che cerca il blocco con una chiave.
+
+        @param key chiave da cercare
+
+        @return posizione del primo blocco con chiave maggiore o uguale
+
+        La ricerca binaria non ha salti condizionali dipendenti dai dati.
+    */
+    std::size_t lower_container(std::uint16_t key) const {
+        if (_keys.empty())
+            return 0;
+
+        const std::uint16_t *keys = _keys.data();
+        std::size_t first = 0;
+        std::size_t count = _keys.size();
+        while (count > 1) {
+            const std::size_t half = count / 2;
+            first = keys[first + half] < key ? first + half : first;
+            count -= half;
+        }
+        return first + (keys[first] < key);
+    }
+
+    /**
+        @brief Funzione di supporto che ricalcola le chiavi e la size
+        dopo aver sostituito i blocchi.
+    */
+    void rebuild_keys(void) {
+        _keys.resize(_containers.size());
+        _size = 0;
+        for (std::size_t i = 0; i < _containers.size(); ++i) {
+            _keys[i] = _containers[i].key();
+            _size += _containers[i].cardinality();
+        }
+    }
+
+public:
+    /**
+        @brief Iteratore costante in avanti, in ordine crescente.
+    */
+    class const_iterator {
+        friend class roaring_set;
+
+        const roaring_set *_set;
+        std::size_t _container;
+        std::uint32_t _low;
+
+        const_iterator(const roaring_set *set, std::size_t container, std::uint32_t low)
+            : _set(set), _container(container), _low(low) {}
+
+        void skip_empty(void) {
+            while (_container < _set->_containers.size() && _low == roaring_container::end_value) {
+                if (++_container < _set->_containers.size())
+                    _low = _set->_containers[_container].next(0);
+            }
+            if (_container == _set->_containers.size())
+                _low = 0;
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef T reference;
+
+        const_iterator() : _set(nullptr), _container(0), _low(0) {}
+
+        value_type operator*() const {
+            return decode((static_cast<std::uint32_t>(_set->_containers[_container].key()) << 16) | _low);
+        }
+
+        const_iterator& operator++() {
+            _low = _set->_containers[_container].next(_low + 1);
+            skip_empty();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return _container == other._container && _low == other._low;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+    /**
+        @brief Costruttore di default.
+
+        @post size() == 0
+    */
+    roaring_set() : _size(0) {}
+
+    /**
+        @brief Costruttore che crea un set riempito con dei dati presi da
+        una sequenza identificata da un iteratore di inizio e uno di fine.
+
+        @param begin iteratore di inizio sequenza
+        @param end iteratore di fine sequenza
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    template <typename Iter>
+    roaring_set(Iter begin, Iter end) : _size(0) {
+        for (; begin != end; ++begin)
+            add(static_cast<value_type>(*begin));
+    }
+
+    /**
+        @brief Funzione che svuota il set e dealloca la memoria allocata.
+
+        @post size() == 0
+    */
+    void clear(void) {
+        std::vector<roaring_container>().swap(_containers);
+        std::vector<std::uint16_t>().swap(_keys);
+        _size = 0;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero degli elementi del set.
+
+        @return numero degli elementi nel set
+    */
+    size_type size(void) const {
+        return _size;
+    }
+
+    /**
+        @brief Funzione che ritorna i byte usati dai blocchi del set.
+
+        @return byte usati
+    */
+    std::size_t bytes(void) const {
+        std::size_t total = _containers.capacity() * sizeof(roaring_container) + _keys.capacity() * sizeof(std::uint16_t);
+        for (std::size_t i = 0; i < _containers.size(); ++i)
+            total += _containers[i].bytes();
+        return total;
+    }
+
+    /**
+        @brief Funzione scambia lo stato tra l'istanza corrente di
+        set e quella passata come parametro.
+
+        @param other set con cui scambiare lo stato
+    */
+    void swap(roaring_set &other) {
+        _containers.swap(other._containers);
+        _keys.swap(other._keys);
+        std::swap(_size, other._size);
+    }
+
+    /**
+        @brief Funzione che aggiunge un elemento al set.
+
+        @param value elemento da aggiungere
+
+        @return true se aggiunto con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool add(value_type value) {
+        const std::uint32_t code = encode(value);
+        const std::uint16_t key = static_cast<std::uint16_t>(code >> 16);
+
+        const std::size_t index = lower_container(key);
+        if (index == _keys.size() || _keys[index] != key) {
+            _keys.reserve(_keys.size() + 1);
+            _containers.insert(_containers.begin() + index, roaring_container(key));
+            _keys.insert(_keys.begin() + index, key);
+        }
+
+        try {
+            if (!_containers[index].add(static_cast<std::uint16_t>(code)))
+                return false;
+        } catch(...) {
+            if (_containers[index].cardinality() == 0) {
+                _containers.erase(_containers.begin() + index);
+                _keys.erase(_keys.begin() + index);
+            }
+            throw;
+        }
+        ++_size;
+        return true;
+    }
+
+    /**
+        @brief Funzione che rimuove un elemento dal set.
+
+        @param value elemento da rimuovere
+
+        @return true se rimosso con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool remove(value_type value) {
+        const std::uint32_t code = encode(value);
+        const std::uint16_t key = static_cast<std::uint16_t>(code >> 16);
+
+        const std::size_t index = lower_container(key);
+        if (index == _keys.size() || _keys[index] != key)
+            return false;
+        if (!_containers[index].remove(static_cast<std::uint16_t>(code)))
+            return false;
+
+        if (_containers[index].cardinality() == 0) {
+            _containers.erase(_containers.begin() + index);
+            _keys.erase(_keys.begin() + index);
+        }
+        --_size;
+        return true;
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di un elemento.
+
+        @param value elemento da controllare
+
+        @return true se l'elemento è presente nel set, false altrimenti
+    */
+    bool contains(value_type value) const {
+        const std::uint32_t code = encode(value);
+        const std::uint16_t key = static_cast<std::uint16_t>(code >> 16);
+
+        const std::size_t index = lower_container(key);
+        return index != _keys.size() && _keys[index] == key &&
+               _containers[index].contains(static_cast<std::uint16_t>(code));
+    }
+
+    /**
+        @brief Funzione che converte in run i blocchi per cui è la
+        rappresentazione più compatta (da chiamare dopo aver riempito il set).
+
+        @return numero di blocchi convertiti in run
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    std::size_t run_optimize(void) {
+        std::size_t converted = 0;
+        for (std::size_t i = 0; i < _containers.size(); ++i)
+            converted += _containers[i].run_optimize();
+        return converted;
+    }
+
+    /**
+        @brief Funzione che controlla se due set sono uguali (contengono gli stessi elementi).
+
+        @param other reference costante del set da controllare
+
+        @return true se i set contengono gli stessi elementi, false altrimenti
+    */
+    bool operator==(const roaring_set &other) const {
+        return _size == other._size && _containers == other._containers;
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore all'inizio della sequenza dati.
+
+        @return iteratore all'inizio della sequenza dati
+    */
+    const_iterator begin(void) const {
+        if (_containers.empty())
+            return end();
+        return const_iterator(this, 0, _containers[0].next(0));
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore alla fine della sequenza dati.
+
+        @return iteratore alla fine della sequenza dati
+    */
+    const_iterator end(void) const {
+        return const_iterator(this, _containers.size(), 0);
+    }
+
+    /**
+        @brief Funzione che unisce al set un altro set, blocco per blocco.
+
+        @param other set da unire
+
+        @return reference al set this
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    roaring_set& operator+=(const roaring_set &other) {
+        std::vector<roaring_container> result;
+        result.reserve(_containers.size() + other._containers.size());
+
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < _containers.size() || j < other._containers.size()) {
+            if (j == other._containers.size() ||
+                (i < _containers.size() && _containers[i].key() < other._containers[j].key())) {
+                result.push_back(_containers[i++]);
+            } else if (i == _containers.size() || other._containers[j].key() < _containers[i].key()) {
+                result.push_back(other._containers[j++]);
+            } else {
+                result.push_back(_containers[i++]);
+                result.back().unite(other._containers[j++]);
+            }
+        }
+
+        _keys.reserve(result.size());
+        _containers.swap(result);
+        rebuild_keys();
+        return *this;
+    }
+
+    /**
+        @brief Funzione che interseca il set con un altro set, blocco per blocco.
+
+        @param other set da intersecare
+
+        @return reference al set this
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    roaring_set& operator-=(const roaring_set &other) {
+        std::vector<roaring_container> result;
+
+        std::size_t i = 0;
+        std::size_t j = 0;
+        while (i < _containers.size() && j < other._containers.size()) {
+            if (_containers[i].key() < other._containers[j].key()) {
+                ++i;
+            } else if (other._containers[j].key() < _containers[i].key()) {
+                ++j;
+            } else {
+                result.push_back(_containers[i++]);
+                result.back().intersect(other._containers[j++]);
+                if (result.back().cardinality() == 0)
+                    result.pop_back();
+            }
+        }
+
+        _keys.reserve(result.size());
+        _containers.swap(result);
+        rebuild_keys();
+        return *this;
+    }
+
+    /**
+        @brief Funzione GLOBALE che implementa l'operatore di stream,
+        con lo stesso formato del set.
+
+        @param os stream di output
+        @param ol set da spedire sullo stream
+
+        @return lo stream di output
+    */
+    friend std::ostream& operator<<(std::ostream &os, const roaring_set &ol) {
+        os << ol._size;
+
+        for (const_iterator curr = ol.begin(); curr != ol.end(); ++curr)
+            os << " (" << *curr << ")";
+
+        return os;
+    }
+};
+
+/**
+    @brief Funzione GLOBALE che ritorna l'unione di due roaring_set
+    (come operator+ del set).
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return il set con gli elementi di almeno uno dei due set
+
+    @throw std::bad_alloc possibile eccezione di allocazione
+*/
+template <typename T>
+roaring_set<T> operator+(const roaring_set<T> &lhs, const roaring_set<T> &rhs) {
+    roaring_set<T> tmp = lhs;
+    tmp += rhs;
+    return tmp;
+}
+
+/**
+    @brief Funzione GLOBALE che ritorna l'intersezione di due roaring_set
+    (come operator- del set).
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return il set con gli elementi comuni ai due set
+
+    @throw std::bad_alloc possibile eccezione di allocazione
+*/
+template <typename T>
+roaring_set<T> operator-(const roaring_set<T> &lhs, const roaring_set<T> &rhs) {
+    roaring_set<T> tmp = lhs;
+    tmp -= rhs;
+    return tmp;
+}
+
+#endif // ROARING_SET_HPP
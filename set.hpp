@@ -9,36 +9,1057 @@
 #ifndef SET_HPP
 #define SET_HPP
 
-#include <algorithm> // std::swap
+#include <algorithm> // std::swap, std::sort
+#include <functional> // std::less
 #include <iostream> // std::ostream
 #include <cassert> // assert
 #include <fstream> // std::ofstream
 #include <string> // std::string
+#include <cstddef> // std::size_t
+#include <type_traits> // std::is_same
+#include <vector> // std::vector
+#include <limits> // std::numeric_limits
+#include <new> // placement new, std::bad_alloc
+#include <stdexcept> // std::length_error
+#include <thread> // std::thread
+#include <exception> // std::exception_ptr
+#include <iterator> // std::distance, std::next
+#include <charconv> // std::to_chars
+#include <locale> // std::locale
+#include <mutex> // std::mutex, std::lock_guard
+#include <map> // std::map
+#include <atomic> // std::atomic
+#include <cstdio> // std::FILE, std::fopen, std::rename
+#include <future> // std::future, std::async
+#include <memory> // std::shared_ptr
+#include <streambuf> // std::streambuf
+
+#ifdef __linux__
+#include <sys/mman.h> // mmap, madvise, munmap
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h> // open
+#include <unistd.h> // fsync, close
+#endif
 
 #define MAX_RESIZE 200
+#define PARALLEL_MIN_CHUNK 4096
+#define ADAPTIVE_INDEX_MIN 16
+#define ADAPTIVE_INDEX_SIZE 128
+
+/**
+  @brief Funtore di hash di default del set.
+
+  Ritorna sempre lo stesso valore, quindi è consistente con qualunque
+  Equal ma non permette di distinguere gli elementi: il set si comporta
+  come la scansione lineare originale. Per abilitare i percorsi veloci
+  bisogna passare un funtore Hash consistente con Equal
+  (elementi uguali devono avere lo stesso hash).
+*/
+struct null_hash {
+    template <typename U>
+    std::size_t operator()(const U &) const {
+        return 0;
+    }
+};
+
+/**
+  @brief Funzione di supporto che mescola i bit di un hash.
+
+  Serve a distribuire bene anche hash "deboli" (es. l'identità sugli interi)
+  prima di usarli come indice o di sommarli nel digest del set.
+  La costante sommata in ingresso fa sì che l'hash 0 non venga mescolato
+  in 0: altrimenti un elemento con hash 0 non cambierebbe il digest.
+
+  @param h hash da mescolare
+
+  @return hash mescolato
+*/
+inline std::size_t mix_hash(std::size_t h) {
+    unsigned long long x = h + 0x9e3779b97f4a7c15ULL;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<std::size_t>(x);
+}
+
+/**
+  @brief Classe di supporto che indicizza un array di elementi tramite hash.
+
+  Tabella ad indirizzamento aperto (linear probing) che contiene le posizioni
+  degli elementi in un array esterno, così da trovare un elemento in tempo
+  costante atteso senza copiare gli elementi stessi.
+*/
+template <typename T, typename Equal, typename Hash, typename SizeT>
+class hash_index {
+public:
+    typedef SizeT size_type;
+
+    /**
+        Valore ritornato da find quando l'elemento non è presente
+    */
+    static const size_type npos = static_cast<size_type>(-1);
+private:
+    Equal _eql;
+    Hash _hash;
+    size_type* _slots; // posizione dell'elemento + 1, 0 se la cella è vuota
+    std::size_t _mask;
+
+    hash_index(const hash_index &other); // non copiabile
+    hash_index& operator=(const hash_index &other);
+
+    std::size_t slot_of(const T &value) const {
+        return mix_hash(_hash(value)) & _mask;
+    }
+
+public:
+    /**
+        @brief Costruttore di default, indice vuoto.
+    */
+    hash_index() : _slots(nullptr), _mask(0) {}
+
+    /**
+        @brief Costruttore che riserva spazio per un numero di elementi.
+
+        @param elements numero di elementi da indicizzare
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    explicit hash_index(size_type elements) : _slots(nullptr), _mask(0) {
+        reserve(elements);
+    }
+
+    /**
+        @brief Distruttore e dealloca la memoria allocata.
+    */
+    ~hash_index() {
+        clear();
+    }
+
+    /**
+        @brief Funzione che svuota l'indice e dealloca la memoria.
+    */
+    void clear(void) {
+        delete[] _slots;
+        _slots = nullptr;
+        _mask = 0;
+    }
+
+    /**
+        @brief Funzione che svuota l'indice e riserva spazio per un numero
+        di elementi tenendo il fattore di carico sotto 1/2.
+
+        @param elements numero di elementi da indicizzare
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void reserve(size_type elements) {
+        std::size_t capacity = 2;
+        while (capacity < static_cast<std::size_t>(elements) * 2)
+            capacity *= 2;
+
+        size_type* tmp = new size_type[capacity]();
+        delete[] _slots;
+        _slots = tmp;
+        _mask = capacity - 1;
+    }
+
+    /**
+        @brief Funzione che ritorna se l'indice è vuoto (senza memoria).
+
+        @return true se non è stato riservato spazio, false altrimenti
+    */
+    bool empty(void) const {
+        return _slots == nullptr;
+    }
+
+    /**
+        @brief Funzione che ritorna la memoria occupata dall'indice.
+
+        @return byte occupati dalle celle dell'indice
+    */
+    std::size_t bytes(void) const {
+        return _slots == nullptr ? 0 : (_mask + 1) * sizeof(size_type);
+    }
+
+    /**
+        @brief Funzione che scambia lo stato con un altro indice.
+
+        @param other indice con cui scambiare lo stato
+    */
+    void swap(hash_index &other) {
+        std::swap(_slots, other._slots);
+        std::swap(_mask, other._mask);
+        std::swap(_eql, other._eql);
+        std::swap(_hash, other._hash);
+    }
+
+    /**
+        @brief Funzione che cerca un elemento nell'indice.
+
+        @param array array indicizzato
+        @param value elemento da cercare
+
+        @return posizione dell'elemento nell'array, npos se non presente
+    */
+    size_type find(const T *array, const T &value) const {
+        if (_slots == nullptr)
+            return npos;
+
+        for (std::size_t i = slot_of(value); _slots[i] != 0; i = (i + 1) & _mask) {
+            if (_eql(array[_slots[i] - 1], value))
+                return _slots[i] - 1;
+        }
+        return npos;
+    }
+
+    /**
+        @brief Funzione che cerca un elemento con una chiave di tipo diverso
+        da T, dato l'hash della chiave (lo stesso che Hash calcola
+        sull'elemento uguale) e un predicato che riconosce l'elemento.
+
+        @param array array indicizzato
+        @param hash hash della chiave
+        @param pred predicato chiamato sugli elementi candidati
+
+        @return posizione dell'elemento nell'array, npos se non presente
+    */
+    template <typename Predicate>
+    size_type find_if(const T *array, std::size_t hash, const Predicate &pred) const {
+        if (_slots == nullptr)
+            return npos;
+
+        for (std::size_t i = mix_hash(hash) & _mask; _slots[i] != 0; i = (i + 1) & _mask) {
+            if (pred(array[_slots[i] - 1]))
+                return _slots[i] - 1;
+        }
+        return npos;
+    }
+
+    /**
+        @brief Funzione che inserisce la posizione di un elemento se
+        nessun elemento uguale è già indicizzato.
+
+        @param array array indicizzato
+        @param pos posizione dell'elemento nell'array
+
+        @return true se inserito, false se un elemento uguale era già presente
+
+        @pre spazio riservato sufficiente (reserve)
+    */
+    bool insert(const T *array, size_type pos) {
+        assert(_slots != nullptr);
+        std::size_t i = slot_of(array[pos]);
+        for (; _slots[i] != 0; i = (i + 1) & _mask) {
+            if (_eql(array[_slots[i] - 1], array[pos]))
+                return false;
+        }
+        _slots[i] = pos + 1;
+        return true;
+    }
+
+private:
+    /**
+        @brief Funzione di supporto che trova la cella che contiene
+        una posizione.
+
+        @param array array indicizzato
+        @param pos posizione indicizzata
+
+        @return indice della cella
+
+        @pre pos è indicizzata
+    */
+    std::size_t cell_of(const T *array, size_type pos) const {
+        std::size_t i = slot_of(array[pos]);
+        while (_slots[i] != pos + 1) {
+            assert(_slots[i] != 0);
+            i = (i + 1) & _mask;
+        }
+        return i;
+    }
+
+public:
+    /**
+        @brief Funzione che toglie una posizione dall'indice, spostando
+        indietro le celle successive della stessa sequenza di probing
+        (senza lasciare celle "cancellate").
+
+        @param array array indicizzato
+        @param pos posizione da togliere
+
+        @pre pos è indicizzata
+    */
+    void erase(const T *array, size_type pos) {
+        std::size_t hole = cell_of(array, pos);
+        for (std::size_t j = (hole + 1) & _mask; _slots[j] != 0; j = (j + 1) & _mask) {
+            const std::size_t home = slot_of(array[_slots[j] - 1]);
+            // la cella j può riempire il buco se la sua posizione naturale
+            // non sta (ciclicamente) tra il buco escluso e j incluso
+            if (((j - home) & _mask) >= ((j - hole) & _mask)) {
+                _slots[hole] = _slots[j];
+                hole = j;
+            }
+        }
+        _slots[hole] = 0;
+    }
+
+    /**
+        @brief Funzione che aggiorna l'indice quando un elemento viene
+        spostato in un'altra posizione dell'array.
+
+        @param array array indicizzato, con l'elemento ancora in from
+        @param from posizione attuale dell'elemento
+        @param to nuova posizione dell'elemento
+
+        @pre from è indicizzata
+    */
+    void relocate(const T *array, size_type from, size_type to) {
+        _slots[cell_of(array, from)] = to + 1;
+    }
+};
+
+/**
+  @brief Classe di supporto che prende il posto di hash_index nei set con
+  null_hash: è vuota e l'indice risulta sempre assente, così il set non
+  paga in memoria un indice che non potrebbe mai costruire.
+*/
+template <typename SizeT>
+class null_index {
+public:
+    typedef SizeT size_type;
+
+    static const size_type npos = static_cast<size_type>(-1);
+
+    void clear(void) {}
+
+    void reserve(size_type) {}
+
+    bool empty(void) const {
+        return true;
+    }
+
+    std::size_t bytes(void) const {
+        return 0;
+    }
+
+    template <typename Index>
+    void swap(Index &) {}
+
+    template <typename U>
+    size_type find(const U *, const U &) const {
+        return npos;
+    }
+
+    template <typename U>
+    bool insert(const U *, size_type) {
+        return false;
+    }
+
+    template <typename U>
+    void erase(const U *, size_type) {}
+
+    template <typename U>
+    void relocate(const U *, size_type, size_type) {}
+};
+
+/**
+  @brief Classe di supporto che prende il posto del digest e del contatore
+  delle ricerche nei set con null_hash: è vuota e vale sempre 0.
+*/
+template <typename N>
+struct null_counter {
+    null_counter(N = N()) {}
+
+    null_counter& operator+=(N) {
+        return *this;
+    }
+
+    null_counter& operator-=(N) {
+        return *this;
+    }
+
+    N load(std::memory_order) const {
+        return N();
+    }
+
+    void store(N, std::memory_order) {}
+
+    bool compare_exchange_weak(N &, N, std::memory_order) {
+        return false;
+    }
+
+    bool compare_exchange_strong(N &, N, std::memory_order) {
+        return false;
+    }
+};
+
+/**
+  @brief Politica di allocazione di default del set: new[]/delete[].
+  Ogni crescita dell'array è limitata a MAX_RESIZE elementi.
+*/
+struct heap_storage {
+    /**
+        Limite di MAX_RESIZE elementi per ogni crescita dell'array
+    */
+    static const bool bounded_growth = true;
+
+    /**
+        @brief Funzione che alloca un array di elementi costruiti di default.
+
+        @param count numero di elementi
+
+        @return puntatore al primo elemento
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    template <typename U>
+    static U* allocate(std::size_t count) {
+        return new U[count];
+    }
+
+    /**
+        @brief Funzione che distrugge e dealloca un array allocato con allocate.
+
+        @param array puntatore al primo elemento
+        @param count numero di elementi
+    */
+    template <typename U>
+    static void deallocate(U *array, std::size_t count) {
+        (void) count;
+        delete[] array;
+    }
+};
+
+/**
+  @brief Politica di allocazione del set per set molto grandi.
+
+  Gli array più piccoli di Threshold byte vengono allocati con new[], quelli
+  più grandi (su Linux) con mmap: si prova prima con pagine esplicite da 2MB
+  (MAP_HUGETLB, se il sistema ne ha di riservate) e altrimenti si chiede al
+  kernel le transparent huge pages con madvise(MADV_HUGEPAGE). Nelle misure
+  di bench.cpp questo non rende più veloci le ricerche casuali.
+
+  Ogni crescita rimappa l'intera regione, quindi con questa politica la
+  capacità cresce in modo geometrico (raddoppio in add) e non di
+  MAX_RESIZE elementi alla volta: il costo di add resta O(1) ammortizzato.
+*/
+template <std::size_t Threshold = (std::size_t(1) << 21)>
+struct huge_page_storage {
+    /**
+        Crescita geometrica, senza il limite di MAX_RESIZE
+    */
+    static const bool bounded_growth = false;
+
+    /**
+        Dimensione di una huge page
+    */
+    static const std::size_t page_size = std::size_t(1) << 21;
+
+    /**
+        @brief Funzione che alloca un array di elementi costruiti di default.
+
+        @param count numero di elementi
+
+        @return puntatore al primo elemento
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    template <typename U>
+    static U* allocate(std::size_t count) {
+#ifdef __linux__
+        const std::size_t bytes = count * sizeof(U);
+        if (bytes < Threshold || count > std::numeric_limits<std::size_t>::max() / sizeof(U) - page_size)
+            return new U[count];
+
+        const std::size_t length = (bytes + page_size - 1) / page_size * page_size;
+        void* memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (memory == MAP_FAILED) {
+            memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED)
+                throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            madvise(memory, length, MADV_HUGEPAGE);
+#endif
+        }
+
+        U* array = static_cast<U*>(memory);
+        std::size_t i = 0;
+        try {
+            for (; i < count; ++i)
+                new (array + i) U;
+        } catch(...) {
+            while (i > 0)
+                array[--i].~U();
+            munmap(memory, length);
+            throw;
+        }
+        return array;
+#else
+        return new U[count];
+#endif
+    }
+
+    /**
+        @brief Funzione che distrugge e dealloca un array allocato con allocate.
+
+        @param array puntatore al primo elemento
+        @param count numero di elementi
+    */
+    template <typename U>
+    static void deallocate(U *array, std::size_t count) {
+#ifdef __linux__
+        const std::size_t bytes = count * sizeof(U);
+        if (array == nullptr || bytes < Threshold || count > std::numeric_limits<std::size_t>::max() / sizeof(U) - page_size) {
+            delete[] array;
+            return;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+            array[i].~U();
+        munmap(array, (bytes + page_size - 1) / page_size * page_size);
+#else
+        (void) count;
+        delete[] array;
+#endif
+    }
+};
+
+/**
+  @brief Politica di esecuzione parallela per la costruzione del set.
+
+  Tag leggero al posto di std::execution::par, che con libstdc++ richiede
+  di linkare TBB. threads == 0 usa std::thread::hardware_concurrency().
+*/
+struct parallel_policy {
+    unsigned threads;
+
+    explicit parallel_policy(unsigned threads = 0) : threads(threads) {}
+};
+
+/**
+    @brief Funzione che esegue una funzione su più thread, passando ad ognuno
+    il proprio indice. Il thread chiamante esegue l'indice 0. Attende la fine
+    di tutti i thread e rilancia la prima eccezione lanciata.
+
+    @param threads numero di thread
+    @param function funzione da eseguire, chiamata con l'indice del thread
+
+    @throw possibile eccezione dalla funzione o dalla creazione dei thread
+*/
+template <typename Function>
+void run_in_threads(unsigned threads, const Function &function) {
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+
+    auto task = [&errors, &function](unsigned index) {
+        try {
+            function(index);
+        } catch(...) {
+            errors[index] = std::current_exception();
+        }
+    };
+
+    try {
+        for (unsigned i = 1; i < threads; ++i)
+            workers.push_back(std::thread(task, i));
+    } catch(...) {
+        for (std::size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+        throw;
+    }
+
+    task(0);
+    for (std::size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+
+    for (unsigned i = 0; i < threads; ++i) {
+        if (errors[i])
+            std::rethrow_exception(errors[i]);
+    }
+}
+
+/**
+  @brief Classe di supporto che bufferizza la scrittura su uno stream.
+
+  Accumula i byte in un buffer grande e li scrive sullo stream con una sola
+  write quando è pieno, evitando di passare per la formattazione degli
+  iostream ad ogni elemento. I byte rimasti vanno scritti chiamando flush.
+*/
+class output_buffer {
+    std::ostream &_os;
+    std::vector<char> _data;
+    std::size_t _used;
+
+    output_buffer(const output_buffer &other); // non copiabile
+    output_buffer& operator=(const output_buffer &other);
+
+public:
+    /**
+        Dimensione del buffer in byte
+    */
+    static const std::size_t buffer_size = std::size_t(1) << 16;
+
+    /**
+        @brief Costruttore che associa il buffer ad uno stream.
+
+        @param os stream di output
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    explicit output_buffer(std::ostream &os) : _os(os), _data(buffer_size), _used(0) {}
+
+    /**
+        @brief Funzione che ritorna se lo stream usa la formattazione di
+        default, l'unico caso in cui il buffer produce gli stessi byte
+        dell'operatore di stream.
+
+        @param os stream da controllare
+
+        @return true se lo stream ha flag, larghezza, precisione e locale di default
+    */
+    static bool default_format(const std::ostream &os) {
+        return os.flags() == (std::ios_base::skipws | std::ios_base::dec) && os.width() == 0 &&
+               os.precision() == 6 && os.getloc() == std::locale::classic();
+    }
+
+    /**
+        @brief Funzione che scrive sullo stream i byte nel buffer.
+    */
+    void flush(void) {
+        if (_used != 0)
+            _os.write(_data.data(), static_cast<std::streamsize>(_used));
+        _used = 0;
+    }
+
+    /**
+        @brief Funzione che aggiunge dei byte al buffer.
+
+        @param data puntatore ai byte
+        @param count numero di byte
+    */
+    void write(const char *data, std::size_t count) {
+        if (_used + count > buffer_size) {
+            flush();
+            if (count > buffer_size) {
+                _os.write(data, static_cast<std::streamsize>(count));
+                return;
+            }
+        }
+        std::copy(data, data + count, _data.data() + _used);
+        _used += count;
+    }
+
+    /**
+        @brief Funzione che riserva spazio contiguo nel buffer.
+
+        @param count numero di byte da riservare (al massimo buffer_size)
+
+        @return puntatore allo spazio riservato, da confermare con commit
+    */
+    char* reserve(std::size_t count) {
+        assert(count <= buffer_size);
+        if (_used + count > buffer_size)
+            flush();
+        return _data.data() + _used;
+    }
+
+    /**
+        @brief Funzione che conferma i byte scritti nello spazio riservato.
+
+        @param end puntatore alla fine dei byte scritti
+    */
+    void commit(const char *end) {
+        _used = static_cast<std::size_t>(end - _data.data());
+    }
+
+    /**
+        @brief Funzione che scrive una stringa.
+
+        @param value stringa da scrivere
+    */
+    void write_value(const std::string &value) {
+        write(value.data(), value.size());
+    }
+
+    /**
+        @brief Funzioni che scrivono un carattere o un bool come farebbe
+        l'operatore di stream.
+
+        @param value valore da scrivere
+    */
+    void write_value(char value) {
+        write(&value, 1);
+    }
+
+    void write_value(signed char value) {
+        write_value(static_cast<char>(value));
+    }
+
+    void write_value(unsigned char value) {
+        write_value(static_cast<char>(value));
+    }
+
+    void write_value(bool value) {
+        write_value(value ? '1' : '0');
+    }
+
+    /**
+        @brief Funzione che scrive un numero intero con std::to_chars.
+
+        @param value numero da scrivere
+    */
+    template <typename U>
+    typename std::enable_if<std::is_integral<U>::value>::type write_value(U value) {
+        char* first = reserve(64);
+        commit(std::to_chars(first, first + 64, value).ptr);
+    }
+
+    /**
+        @brief Funzione che scrive un numero in virgola mobile con
+        std::to_chars, nello stesso formato di printf("%.6g") usato
+        dall'operatore di stream.
+
+        @param value numero da scrivere
+    */
+    template <typename U>
+    typename std::enable_if<std::is_floating_point<U>::value>::type write_value(U value) {
+        char* first = reserve(64);
+        commit(std::to_chars(first, first + 64, value, std::chars_format::general, 6).ptr);
+    }
+};
+
+/**
+  @brief Trait che indica i tipi che output_buffer sa scrivere da solo:
+  stringhe, caratteri, bool e numeri (non i caratteri wide).
+*/
+template <typename U>
+struct fast_writable : std::integral_constant<bool,
+    std::is_same<U, std::string>::value || std::is_floating_point<U>::value ||
+    (std::is_integral<U>::value && !std::is_same<U, wchar_t>::value &&
+     !std::is_same<U, char16_t>::value && !std::is_same<U, char32_t>::value)> {};
+
+/**
+  @brief Struttura con l'occupazione di memoria di un set in byte.
+*/
+struct set_memory_usage {
+    std::size_t buffer_bytes; // byte dell'array (capacità * sizeof(T))
+    std::size_t slack_bytes; // byte delle celle non usate (capacità - size)
+    std::size_t deep_bytes; // byte allocati dagli elementi (es. std::string)
+
+    set_memory_usage() : buffer_bytes(0), slack_bytes(0), deep_bytes(0) {}
+
+    /**
+        @brief Funzione che ritorna il totale dei byte occupati.
+
+        @return buffer_bytes + deep_bytes
+    */
+    std::size_t total(void) const {
+        return buffer_bytes + deep_bytes;
+    }
+
+    /**
+        @brief Operatore che somma l'occupazione di un altro set.
+
+        @param other occupazione da sommare
+
+        @return reference a this
+    */
+    set_memory_usage& operator+=(const set_memory_usage &other) {
+        buffer_bytes += other.buffer_bytes;
+        slack_bytes += other.slack_bytes;
+        deep_bytes += other.deep_bytes;
+        return *this;
+    }
+};
+
+/**
+  @brief Funtore che ritorna i byte allocati sullo heap da una std::string
+  (0 se la stringa usa il buffer interno).
+*/
+struct string_deep_size {
+    std::size_t operator()(const std::string &value) const {
+        const char *data = value.data();
+        const char *object = reinterpret_cast<const char*>(&value);
+        if (data >= object && data < object + sizeof(value))
+            return 0;
+        return value.capacity() + 1;
+    }
+};
+
+/**
+  @brief Registro globale dei set tracciati.
+
+  I set registrati con set::track compaiono nel registro con la loro
+  etichetta fino a untrack o alla distruzione. L'occupazione viene letta
+  al momento dell'enumerazione: va fatta quando i set non vengono
+  modificati da altri thread.
+*/
+class set_registry {
+public:
+    typedef set_memory_usage (*usage_function)(const void *object);
+
+    /**
+        Set tracciato con la sua occupazione
+    */
+    struct entry {
+        std::string tag;
+        const void *object;
+        set_memory_usage usage;
+    };
+private:
+    struct record {
+        std::string tag;
+        usage_function usage;
+    };
+
+    mutable std::mutex _mutex;
+    std::map<const void*, record> _records;
+
+    set_registry() {}
+    set_registry(const set_registry &other); // non copiabile
+    set_registry& operator=(const set_registry &other);
+
+public:
+    /**
+        @brief Funzione che ritorna il registro globale. Il registro non
+        viene mai distrutto, così i set statici possono uscire in qualunque
+        ordine.
+
+        @return reference al registro
+    */
+    static set_registry& instance(void) {
+        static set_registry *registry = new set_registry();
+        return *registry;
+    }
+
+    /**
+        @brief Funzione che registra (o rietichetta) un set.
+
+        @param object indirizzo del set
+        @param tag etichetta del set
+        @param usage funzione che calcola l'occupazione del set
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void add(const void *object, const std::string &tag, usage_function usage) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        record &rec = _records[object];
+        rec.tag = tag;
+        rec.usage = usage;
+    }
+
+    /**
+        @brief Funzione che toglie un set dal registro.
+
+        @param object indirizzo del set
+    */
+    void remove(const void *object) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _records.erase(object);
+    }
+
+    /**
+        @brief Funzione che ritorna il numero di set tracciati.
+
+        @return numero di set tracciati
+    */
+    std::size_t size(void) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _records.size();
+    }
+
+    /**
+        @brief Funzione che enumera i set tracciati con la loro occupazione.
+
+        @return set tracciati
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    std::vector<entry> entries(void) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<entry> result;
+        result.reserve(_records.size());
+
+        std::map<const void*, record>::const_iterator curr = _records.begin();
+        for (; curr != _records.end(); ++curr) {
+            entry e;
+            e.tag = curr->second.tag;
+            e.object = curr->first;
+            e.usage = curr->second.usage(curr->first);
+            result.push_back(e);
+        }
+        return result;
+    }
+
+    /**
+        @brief Funzione che somma l'occupazione dei set tracciati per etichetta.
+
+        @return occupazione per etichetta
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    std::map<std::string, set_memory_usage> usage_by_tag(void) const {
+        const std::vector<entry> all = entries();
+        std::map<std::string, set_memory_usage> result;
+        for (std::size_t i = 0; i < all.size(); ++i)
+            result[all[i].tag] += all[i].usage;
+        return result;
+    }
+};
 
 /**
   @brief classe set ordinata
 
   La classe implementa un generico set di oggetti T.
+  SizeT è il tipo (senza segno) usato per size e capacità: unsigned int di
+  default per avere un header compatto, un tipo a 64 bit per set con più
+  di 4G elementi. Storage è la politica di allocazione dell'array
+  (heap_storage o huge_page_storage).
+
+  Se viene fornito un Hash il set è adattivo: finché è piccolo cerca con
+  la scansione lineare dell'array, quando la size raggiunge
+  ADAPTIVE_INDEX_SIZE (o quando le ricerche fatte bastano a ripagarne la
+  costruzione, anche in un set solo letto) affianca all'array un
+  hash_index e cerca in tempo costante. Con l'indice la capacità cresce in
+  modo geometrico, perché resize deve ricostruirlo. L'indice viene tolto
+  quando la size scende sotto ADAPTIVE_INDEX_MIN. L'ordine degli elementi
+  e l'interfaccia non cambiano.
+
+  Con null_hash indice, contatore delle ricerche e digest non occupano
+  memoria (null_index, null_counter): l'header del set resta di 32 byte.
+
+  Per le fasi di sola lettura freeze<Less>() riordina l'array nel layout di
+  Eytzinger (albero binario in ampiezza) e contains diventa una ricerca
+  senza salti e con prefetch. La prima add/remove che modifica il set lo
+  scongela automaticamente.
 */
-template <typename T, typename Equal>
+template <typename T, typename Equal, typename Hash = null_hash,
+          typename SizeT = unsigned int, typename Storage = heap_storage>
 class set {
 public:
     /**
         TypeDef del tipo contenuto nel set
     */
     typedef T value_type;
-    typedef unsigned int size_type;
+    typedef SizeT size_type;
+    typedef Equal equal_type;
+    typedef Hash hash_type;
 private:
-    Equal _eql;
+    static_assert(std::numeric_limits<SizeT>::is_integer && !std::numeric_limits<SizeT>::is_signed,
+                  "SizeT deve essere un intero senza segno");
+
+    static const bool hashed = !std::is_same<Hash, null_hash>::value;
+
+    /**
+        TypeDef dei tipi di indice, digest e contatore delle ricerche,
+        vuoti con null_hash
+    */
+    typedef typename std::conditional<hashed, hash_index<T, Equal, Hash, SizeT>, null_index<SizeT> >::type index_type;
+    typedef typename std::conditional<hashed, std::size_t, null_counter<std::size_t> >::type digest_type;
+    typedef typename std::conditional<hashed, std::atomic<size_type>, null_counter<size_type> >::type lookups_type;
+
+    [[no_unique_address]] Equal _eql;
+    [[no_unique_address]] Hash _hash;
     value_type* _array;
     size_type _capacity;
     size_type _size;
+    [[no_unique_address]] digest_type _digest; // somma degli hash mescolati degli elementi
+    bool _tracked; // true se registrato nel set_registry
+    [[no_unique_address]] mutable index_type _index; // vuoto se il set usa la scansione lineare
+    [[no_unique_address]] mutable lookups_type _lookups; // ricerche lineari dall'ultima migrazione, o index_ready/index_building
+
+    /**
+        Valori di _lookups che non contano ricerche: indice pronto e
+        indice in costruzione da parte di una ricerca
+    */
+    static constexpr size_type index_ready = static_cast<size_type>(-1);
+    static constexpr size_type index_building = static_cast<size_type>(-2);
+
+    /**
+        Tipo della funzione di ricerca del set congelato, istanziata
+        sull'ordinamento passato a freeze
+    */
+    typedef size_type (*frozen_find_type)(const value_type*, size_type, const value_type&, const Equal&);
+
+    frozen_find_type _frozen_find; // nullptr se il set non è congelato
+
+    /**
+        @brief Funzione di supporto che cerca un elemento nell'array in
+        layout di Eytzinger: l'elemento k (contando da 1) ha i figli in 2k
+        e 2k+1. La discesa non ha salti condizionati e carica in anticipo
+        i nodi di quattro livelli più in basso; alla fine si risale al
+        primo elemento non minore del valore cercato.
+
+        @param array array in layout di Eytzinger
+        @param size numero di elementi
+        @param value elemento da cercare
+        @param eql funtore di uguaglianza
+
+        @return posizione dell'elemento, size se non presente
+    */
+    template <typename Less>
+    static size_type eytzinger_find(const value_type *array, size_type size, const value_type &value, const Equal &eql) {
+        const Less less = Less();
+        std::size_t k = 1;
+        while (k <= size) {
+#if defined(__GNUC__)
+            if (16 * k <= size)
+                __builtin_prefetch(array + 16 * k - 1);
+#endif
+            k = 2 * k + static_cast<std::size_t>(less(array[k - 1], value));
+        }
+        while (k & 1)
+            k >>= 1;
+        k >>= 1;
+
+        if (k == 0 || !eql(array[k - 1], value))
+            return size;
+        return static_cast<size_type>(k - 1);
+    }
+
+    /**
+        @brief Funzione di supporto che copia un array ordinato nel layout
+        di Eytzinger visitando l'albero in ordine simmetrico.
+
+        @param out array di destinazione
+        @param sorted array ordinato
+        @param size numero di elementi
+        @param k nodo corrente (contando da 1)
+        @param next prossimo elemento di sorted da copiare
+    */
+    static void eytzinger_fill(value_type *out, const value_type *sorted, size_type size, std::size_t k, size_type &next) {
+        if (k > size)
+            return;
+        eytzinger_fill(out, sorted, size, 2 * k, next);
+        out[k - 1] = sorted[next++];
+        eytzinger_fill(out, sorted, size, 2 * k + 1, next);
+    }
+
+    /**
+        @brief Funzione di supporto che calcola il contributo
+        di un elemento al digest del set.
+
+        @param value elemento di cui calcolare il contributo
+
+        @return hash mescolato dell'elemento
+    */
+    std::size_t digest_of(const value_type &value) const {
+        return mix_hash(_hash(value));
+    }
 
     /**
         @brief Funzione di supporto che aumenta/diminuisce 
         la capacità del set con un valore massimo di aumento
+        (MAX_RESIZE, se Storage::bounded_growth e il set non ha l'indice:
+        ricostruire l'indice ad ogni passo renderebbe add quadratica)
 
         @param size possibile nuova capacità del set
 
@@ -50,7 +1071,7 @@ private:
     */
     void resize(size_type size) {
         assert(size >= 0);
-        if (size > _capacity + MAX_RESIZE)
+        if (Storage::bounded_growth && _index.empty() && size > _capacity && size - _capacity > MAX_RESIZE)
             size = _capacity + MAX_RESIZE;
         if (_size > size)
             size = _size;
@@ -59,12 +1080,260 @@ private:
             return;
         }
 
-        set tmp(size);
+        value_type* tmp = Storage::template allocate<value_type>(size);
+        try {
+            for (size_type i = 0; i < _size; ++i)
+                tmp[i] = _array[i];
+        } catch(...) {
+            Storage::deallocate(tmp, size);
+            throw;
+        }
 
-        for (size_type i = 0; i < _size; ++i)
-            tmp.add(_array[i]);
-        
-        this->swap(tmp); 
+        Storage::deallocate(_array, _capacity);
+        _array = tmp;
+        _capacity = size;
+
+        rebuild_index();
+    }
+
+    /**
+        @brief Funzione di supporto che decide se il set deve usare l'indice:
+        mai con null_hash o sotto ADAPTIVE_INDEX_MIN elementi, sempre se
+        l'indice c'è già (isteresi) o se la size raggiunge ADAPTIVE_INDEX_SIZE,
+        altrimenti quando le ricerche lineari fatte sono almeno quante
+        gli elementi (costo della costruzione dell'indice).
+
+        @return true se il set deve usare l'indice
+    */
+    bool wants_index(void) const {
+        if (std::is_same<Hash, null_hash>::value || _size < ADAPTIVE_INDEX_MIN || _frozen_find != nullptr)
+            return false;
+        return !_index.empty() || _size >= ADAPTIVE_INDEX_SIZE ||
+               _lookups.load(std::memory_order_relaxed) >= _size;
+    }
+
+    /**
+        @brief Funzione di supporto che riempie l'indice con tutto l'array.
+        L'indice è solo un'ottimizzazione: se manca la memoria il set
+        resta alla scansione lineare.
+
+        @return true se l'indice è stato costruito, false altrimenti
+    */
+    bool fill_index(void) const {
+        try {
+            _index.reserve(_capacity);
+            for (size_type i = 0; i < _size; ++i)
+                _index.insert(_array, i);
+            return true;
+        } catch(const std::bad_alloc &) {
+            _index.clear();
+            return false;
+        }
+    }
+
+    /**
+        @brief Funzione di supporto che costruisce l'indice su tutto l'array.
+    */
+    void build_index(void) {
+        _lookups.store(fill_index() ? index_ready : 0, std::memory_order_relaxed);
+    }
+
+    /**
+        @brief Funzione di supporto che ricostruisce l'indice dopo che gli
+        elementi sono stati spostati (o l'array rilocato), mantenendolo
+        finché la size non scende sotto ADAPTIVE_INDEX_MIN.
+    */
+    void rebuild_index(void) {
+        const bool indexed = !_index.empty();
+        _index.clear();
+        if (indexed)
+            _lookups.store(0, std::memory_order_relaxed);
+        if (indexed && _size >= ADAPTIVE_INDEX_MIN)
+            build_index();
+        else
+            adapt();
+    }
+
+    /**
+        @brief Funzione di supporto che migra il set tra scansione lineare
+        e indice secondo wants_index.
+    */
+    void adapt(void) {
+        if (wants_index()) {
+            if (_index.empty())
+                build_index();
+        } else if (!_index.empty()) {
+            _index.clear();
+            _lookups.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+        @brief Funzione di supporto che cerca la posizione di un elemento
+        con l'indice o con la scansione lineare.
+
+        @param value reference costante dell'elemento da cercare
+
+        @return posizione dell'elemento nel set, _size se non presente
+    */
+    size_type position_of(const value_type &value) const {
+        if (_frozen_find != nullptr)
+            return _frozen_find(_array, _size, value, _eql);
+
+        if (indexed()) {
+            const size_type pos = _index.find(_array, value);
+            return pos == index_type::npos ? _size : pos;
+        }
+
+        for (size_type i = 0; i < _size; ++i) {
+            if (_eql(_array[i], value))
+                return i;
+        }
+        return _size;
+    }
+
+    /**
+        @brief Funzione di supporto che conta una ricerca lineare richiesta
+        dall'utente e, quando le ricerche arrivano alla size, costruisce
+        l'indice anche se il set viene solo letto. Il conteggio è un solo
+        tentativo di compare_exchange (relaxed): ricerche concorrenti possono
+        perdere qualche conteggio, ma non aspettano. La ricerca che porta il
+        contatore a index_building costruisce l'indice, le altre continuano
+        con la scansione lineare finché index_ready non viene pubblicato
+        (release, letto con acquire da indexed).
+    */
+    void count_lookup(void) const {
+        if (!hashed || _frozen_find != nullptr)
+            return;
+
+        size_type seen = _lookups.load(std::memory_order_relaxed);
+        if (seen >= index_building)
+            return;
+        if (_size < ADAPTIVE_INDEX_MIN || seen + 1 < _size) {
+            _lookups.compare_exchange_weak(seen, seen + 1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (_lookups.compare_exchange_strong(seen, index_building, std::memory_order_acquire)) {
+            if (fill_index())
+                _lookups.store(index_ready, std::memory_order_release);
+            else
+                _lookups.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+        @brief Funzione di supporto che calcola la capacità ridotta
+        a 3/4 senza overflow.
+
+        @param capacity capacità da ridurre
+
+        @return capacità ridotta
+    */
+    static size_type shrunk_capacity(size_type capacity) {
+        return capacity / 4 * 3 + capacity % 4 * 3 / 4;
+    }
+
+    /**
+        @brief Funzione di supporto registrata nel set_registry che
+        calcola l'occupazione di un set.
+
+        @param object indirizzo del set
+
+        @return occupazione di memoria del set
+    */
+    static set_memory_usage usage_of(const void *object) {
+        return static_cast<const set*>(object)->memory_usage();
+    }
+
+    /**
+        @brief Funzione di supporto che riempie un set vuoto con i dati di
+        una sequenza usando più thread. Ogni thread divide la sua parte di
+        input in partizioni per hash, poi ogni thread deduplica una partizione
+        (partizioni diverse non possono contenere elementi uguali) e infine
+        le partizioni vengono copiate in un array allocato una sola volta.
+        Con null_hash si usa un solo thread.
+
+        @param threads numero di thread da usare
+        @param begin iteratore (almeno forward) di inizio sequenza
+        @param end iteratore di fine sequenza
+
+        @pre _size == 0 && _array == nullptr
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw std::length_error se gli elementi sono più di max_size()
+    */
+    template <typename Iter>
+    void build_parallel(unsigned threads, Iter begin, Iter end) {
+        typedef hash_index<value_type, Equal, Hash, size_type> index_type;
+        typedef std::vector<value_type> part_type;
+
+        const std::size_t count = static_cast<std::size_t>(std::distance(begin, end));
+        if (count == 0)
+            return;
+        if (count > max_size())
+            throw std::length_error("set: troppi elementi");
+
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads > count / PARALLEL_MIN_CHUNK)
+            threads = static_cast<unsigned>(count / PARALLEL_MIN_CHUNK);
+        if (threads == 0 || std::is_same<Hash, null_hash>::value)
+            threads = 1;
+
+        std::vector<Iter> bounds(1, begin);
+        for (unsigned t = 1; t < threads; ++t)
+            bounds.push_back(std::next(bounds.back(), count / threads));
+        bounds.push_back(end);
+
+        std::vector<std::vector<part_type> > parts(threads, std::vector<part_type>(threads));
+        run_in_threads(threads, [&](unsigned t) {
+            for (Iter curr = bounds[t]; curr != bounds[t + 1]; ++curr) {
+                const value_type value = static_cast<value_type>(*curr);
+                const std::size_t h = mix_hash(_hash(value)) >> (sizeof(std::size_t) * 4);
+                parts[t][h % threads].push_back(value);
+            }
+        });
+
+        std::vector<part_type> unique(threads);
+        std::vector<std::size_t> digests(threads, 0);
+        run_in_threads(threads, [&](unsigned p) {
+            std::size_t total = 0;
+            for (unsigned t = 0; t < threads; ++t)
+                total += parts[t][p].size();
+
+            part_type &result = unique[p];
+            result.reserve(total);
+            index_type index(static_cast<size_type>(total));
+            for (unsigned t = 0; t < threads; ++t) {
+                for (std::size_t i = 0; i < parts[t][p].size(); ++i) {
+                    result.push_back(parts[t][p][i]);
+                    if (index.insert(result.data(), static_cast<size_type>(result.size() - 1)))
+                        digests[p] += digest_of(result.back());
+                    else
+                        result.pop_back();
+                }
+                part_type().swap(parts[t][p]);
+            }
+        });
+
+        std::vector<std::size_t> offsets(threads + 1, 0);
+        for (unsigned p = 0; p < threads; ++p)
+            offsets[p + 1] = offsets[p] + unique[p].size();
+
+        const size_type total = static_cast<size_type>(offsets[threads]);
+        _array = Storage::template allocate<value_type>(total);
+        _capacity = total;
+
+        run_in_threads(threads, [&](unsigned p) {
+            std::copy(unique[p].begin(), unique[p].end(), _array + offsets[p]);
+        });
+
+        _size = total;
+        for (unsigned p = 0; p < threads; ++p)
+            _digest += digests[p];
+
+        adapt();
     }
 
 public:
@@ -75,7 +1344,7 @@ public:
         @post _capacity == 0
         @post _size == 0
     */
-    set() : _array(nullptr), _capacity(0), _size(0) {}
+    set() : _array(nullptr), _capacity(0), _size(0), _digest(0), _tracked(false), _lookups(0), _frozen_find(nullptr) {}
 
     /**
         @brief Costruttore secondario.
@@ -88,9 +1357,9 @@ public:
 
         @throw std::bad_alloc possibile eccezione di allocazione
     */
-    explicit set(size_type capacity) : _array(nullptr), _capacity(0), _size(0) {
+    explicit set(size_type capacity) : _array(nullptr), _capacity(0), _size(0), _digest(0), _tracked(false), _lookups(0), _frozen_find(nullptr) {
         assert(capacity >= 0);
-        _array = new value_type[capacity];
+        _array = Storage::template allocate<value_type>(capacity);
         _capacity = capacity;
     }
 
@@ -105,16 +1374,20 @@ public:
 
         @throw std::bad_alloc possibile eccezione di allocazione
     */
-    set(const set &other) : _array(nullptr), _capacity(0), _size(0) {
+    set(const set &other) : _array(nullptr), _capacity(0), _size(0), _digest(0), _tracked(false), _lookups(0), _frozen_find(nullptr) {
         try {
-            value_type* tmp = new value_type[other._capacity];
+            _array = Storage::template allocate<value_type>(other._capacity);
             _capacity = other._capacity;
 
             for (size_type i = 0; i < other._size; ++i)
-                tmp[i] = other._array[i];
+                _array[i] = other._array[i];
 
-            _array = tmp;
             _size = other._size;
+            _digest = other._digest;
+            _frozen_find = other._frozen_find;
+
+            if (other.indexed())
+                build_index();
         } catch(...) {
             clear();
             throw;
@@ -151,7 +1424,7 @@ public:
         @throw std::bad_alloc possibile eccezione di allocazione
     */
     template <typename Iter>
-    set(Iter begin, Iter end) : _array(nullptr), _capacity(0), _size(0) {
+    set(Iter begin, Iter end) : _array(nullptr), _capacity(0), _size(0), _digest(0), _tracked(false), _lookups(0), _frozen_find(nullptr) {
         Iter curr = begin;
         try {
             for(; curr!=end; ++curr) 
@@ -162,6 +1435,31 @@ public:
         }
     }
 
+    /**
+        @brief Costruttore che crea un set riempito con dei dati presi da
+        una sequenza usando più thread, con una sola allocazione finale.
+        Serve un Hash per dividere il lavoro tra i thread, con null_hash
+        la costruzione è sequenziale.
+
+        @param policy politica di esecuzione (numero di thread)
+        @param begin iteratore (almeno forward) di inizio sequenza
+        @param end iteratore di fine sequenza
+
+        @post capacity() == size()
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw std::length_error se gli elementi sono più di max_size()
+    */
+    template <typename Iter>
+    set(const parallel_policy &policy, Iter begin, Iter end) : _array(nullptr), _capacity(0), _size(0), _digest(0), _tracked(false), _lookups(0), _frozen_find(nullptr) {
+        try {
+            build_parallel(policy.threads, begin, end);
+        } catch(...) {
+            clear();
+            throw;
+        }
+    }
+
     /**
         @brief Distruttore e dealloca la memoria allocata.
 
@@ -169,45 +1467,131 @@ public:
         @post _capacity == 0
         @post _size == 0
     */
-    ~set() {
-        clear(); 
+    ~set() {
+        untrack();
+        clear(); 
+    }
+
+    /**
+        @brief Funzione che svuota il set e dealloca la memoria allocata.
+
+        @post _array == nullptr
+        @post _capacity == 0
+        @post _size == 0
+    */
+    void clear(void) {
+        Storage::deallocate(_array, _capacity);
+        _array = nullptr;
+        _capacity = 0;
+        _size = 0;
+        _digest = 0;
+        _index.clear();
+        _lookups.store(0, std::memory_order_relaxed);
+        _frozen_find = nullptr;
+    }
+
+    /**
+        @brief Funzione che rimuove tutti gli elementi mantenendo la
+        capacità, per riusare il set come buffer senza riallocare l'array.
+        Gli elementi restano nell'array finché non vengono sovrascritti.
+        L'eventuale indice viene liberato, come per ogni set sotto
+        ADAPTIVE_INDEX_MIN elementi.
+
+        @post size() == 0
+        @post frozen() == false
+    */
+    void erase_all(void) {
+        _size = 0;
+        _digest = 0;
+        _index.clear();
+        _lookups.store(0, std::memory_order_relaxed);
+        _frozen_find = nullptr;
+    }
+
+    /**
+        @brief Funzione che ritorna quanti elementi può contenere il set.
+
+        @return numero che rappresenta la capacità del set
+    */
+    size_type capacity(void) const {
+        return _capacity;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero degli elementi del set.
+
+        @return numero degli elementi nel set
+    */
+    size_type size(void) const {
+        return _size;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero massimo di elementi del set.
+
+        @return numero massimo di elementi rappresentabile con size_type
+    */
+    size_type max_size(void) const {
+        return std::numeric_limits<size_type>::max();
     }
 
     /**
-        @brief Funzione che svuota il set e dealloca la memoria allocata.
+        @brief Funzione che ritorna l'occupazione di memoria del set,
+        senza la memoria allocata dagli elementi. L'eventuale indice
+        è contato nel buffer.
 
-        @post _array == nullptr
-        @post _capacity == 0
-        @post _size == 0
+        @return occupazione di memoria (deep_bytes == 0)
     */
-    void clear(void) {
-        delete[] _array;
-        _array = nullptr;
-        _capacity = 0;
-        _size = 0;
+    set_memory_usage memory_usage(void) const {
+        set_memory_usage usage;
+        usage.buffer_bytes = static_cast<std::size_t>(_capacity) * sizeof(value_type) + (indexed() ? _index.bytes() : 0);
+        usage.slack_bytes = static_cast<std::size_t>(_capacity - _size) * sizeof(value_type);
+        return usage;
     }
 
     /**
-        @brief Funzione che ritorna quanti elementi può contenere il set.
+        @brief Funzione che ritorna l'occupazione di memoria del set,
+        compresa la memoria allocata dagli elementi.
 
-        @return numero che rappresenta la capacità del set
+        @param deep_size funtore che ritorna i byte allocati da un elemento
+        (es. string_deep_size)
+
+        @return occupazione di memoria
     */
-    size_type capacity(void) const {
-        return _capacity;
+    template <typename DeepSize>
+    set_memory_usage memory_usage(const DeepSize &deep_size) const {
+        set_memory_usage usage = memory_usage();
+        for (size_type i = 0; i < _size; ++i)
+            usage.deep_bytes += deep_size(_array[i]);
+        return usage;
     }
 
     /**
-        @brief Funzione che ritorna il numero degli elementi del set.
+        @brief Funzione che registra il set nel set_registry con
+        un'etichetta. Le copie del set non sono registrate.
 
-        @return numero degli elementi nel set
+        @param tag etichetta del set
+
+        @throw std::bad_alloc possibile eccezione di allocazione
     */
-    size_type size(void) const {
-        return _size;
+    void track(const std::string &tag) {
+        set_registry::instance().add(this, tag, &set::usage_of);
+        _tracked = true;
+    }
+
+    /**
+        @brief Funzione che toglie il set dal set_registry.
+    */
+    void untrack(void) {
+        if (_tracked)
+            set_registry::instance().remove(this);
+        _tracked = false;
     }
 
     /**
         @brief Funzione scambia lo stato tra l'istanza corrente di
-        set e quella passata come parametro.
+        set e quella passata come parametro. La registrazione nel
+        set_registry resta legata all'istanza.
 
         @param other set con cui scambiare lo stato
     */
@@ -215,7 +1599,15 @@ public:
         std::swap(_array, other._array);
         std::swap(_capacity, other._capacity);
         std::swap(_size, other._size);
+        std::swap(_digest, other._digest);
         std::swap(_eql, other._eql);
+        std::swap(_hash, other._hash);
+        _index.swap(other._index);
+        std::swap(_frozen_find, other._frozen_find);
+
+        const size_type lookups = _lookups.load(std::memory_order_relaxed);
+        _lookups.store(other._lookups.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other._lookups.store(lookups, std::memory_order_relaxed);
     }
 
     /**
@@ -241,14 +1633,26 @@ public:
         @return true se aggiunto con successo, false altrimenti
 
         @throw std::bad_alloc possibile eccezione di allocazione
+        @throw std::length_error se il set contiene già max_size() elementi
     */
     bool add(const value_type &value) {
-        if (!contains(value)) {
+        if (position_of(value) == _size) {
+            thaw();
             if (_capacity == 0)
                 resize(1);
-            else if (_capacity == _size)
-                resize(_capacity * 2);
-            _array[_size++] = value;
+            else if (_capacity == _size) {
+                if (_size == max_size())
+                    throw std::length_error("set: raggiunto il numero massimo di elementi");
+                resize(_capacity > max_size() / 2 ? max_size() : _capacity * 2);
+            }
+            _array[_size] = value;
+            if (!_index.empty())
+                _index.insert(_array, _size);
+            ++_size;
+            _digest += digest_of(value);
+
+            if (_index.empty())
+                adapt();
             return true;
         }
         return false;
@@ -264,17 +1668,203 @@ public:
         @throw std::bad_alloc possibile eccezione di allocazione
     */
     bool remove(const value_type &value) {
-        for (size_type i = 0; i < _size; ++i) {
-            if (_eql(_array[i], value)) {
-                std::swap(_array[i], _array[--_size]);
+        const size_type index = position_of(value);
+        if (index == _size)
+            return false;
+
+        remove_at(index);
+        return true;
+    }
+
+    /**
+        @brief Funzione che rimuove l'elemento in una posizione del set.
+        Al suo posto viene spostato l'ultimo elemento, le posizioni degli
+        altri elementi restano invariate.
+
+        @param index posizione dell'elemento da rimuovere
+
+        @pre index < _size
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void remove_at(const size_type index) {
+        assert(index < _size);
+        thaw();
+        _digest -= digest_of(_array[index]);
+        if (!_index.empty()) {
+            _index.erase(_array, index);
+            if (index != _size - 1)
+                _index.relocate(_array, _size - 1, index);
+        }
+        std::swap(_array[index], _array[--_size]);
+
+        if (_capacity / 2 >= _size)
+            resize(shrunk_capacity(_capacity));
+        else
+            adapt();
+    }
+
+    /**
+        @brief Funzione che cerca la posizione di un elemento.
+
+        @param value reference costante dell'elemento da cercare
 
-                if (_capacity / 2 >= _size)
-                    resize(_capacity * 3 / 4);
+        @return posizione dell'elemento nel set, size() se non presente
+    */
+    size_type index_of(const value_type &value) const {
+        count_lookup();
+        return position_of(value);
+    }
+
+    /**
+        @brief Funzione che congela il set per una fase di sola lettura:
+        ordina gli elementi con Less e li dispone nel layout di Eytzinger,
+        così contains e index_of diventano ricerche in O(log N) senza salti.
+        L'eventuale indice hash viene liberato. Iteratori e operator[]
+        continuano a funzionare (nel nuovo ordine).
 
-                return true;
+        @pre Less è un ordinamento stretto, costruibile di default, in cui
+        elementi uguali per Equal sono equivalenti
+        @post frozen() == true
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw possibile eccezione da Less o dalla copia degli elementi
+        (il set resta valido e non congelato, con gli elementi in un
+        ordine qualunque)
+    */
+    template <typename Less = std::less<T>>
+    void freeze(void) {
+        _frozen_find = nullptr;
+        if (_size != 0) {
+            value_type* tmp = Storage::template allocate<value_type>(_capacity);
+            try {
+                std::sort(_array, _array + _size, Less());
+                size_type next = 0;
+                eytzinger_fill(tmp, _array, _size, 1, next);
+            } catch(...) {
+                Storage::deallocate(tmp, _capacity);
+                rebuild_index();
+                throw;
             }
+
+            Storage::deallocate(_array, _capacity);
+            _array = tmp;
         }
-        return false;
+
+        _index.clear();
+        _lookups.store(0, std::memory_order_relaxed);
+        _frozen_find = &eytzinger_find<Less>;
+    }
+
+    /**
+        @brief Funzione che scongela il set, senza spostare gli elementi.
+        Viene chiamata automaticamente dalle funzioni che modificano il set.
+        Se il set ha un Hash l'indice viene ricostruito secondo la politica
+        adattiva.
+
+        @post frozen() == false
+    */
+    void thaw(void) {
+        if (_frozen_find != nullptr) {
+            _frozen_find = nullptr;
+            adapt();
+        }
+    }
+
+    /**
+        @brief Funzione che ritorna se il set cerca con l'indice hash
+        adattivo.
+
+        @return true se il set ha l'indice, false altrimenti
+    */
+    bool indexed(void) const {
+        return _lookups.load(std::memory_order_acquire) == index_ready;
+    }
+
+    /**
+        @brief Funzione che ritorna se il set è congelato.
+
+        @return true se il set è congelato, false altrimenti
+    */
+    bool frozen(void) const {
+        return _frozen_find != nullptr;
+    }
+
+    /**
+        @brief Funzione che rimuove tutti gli elementi che soddisfano un
+        predicato. L'array viene compattato con una sola passata e la
+        capacità viene ridotta al massimo una volta alla fine.
+
+        @param predicate predicato da applicare ad ogni elemento del set
+
+        @return numero degli elementi rimossi
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw possibile eccezione dal predicato
+    */
+    template <typename Predicate>
+    size_type erase_if(const Predicate &predicate) {
+        thaw();
+        size_type kept = 0;
+        size_type i = 0;
+        try {
+            for (; i < _size; ++i) {
+                if (predicate(_array[i]))
+                    _digest -= digest_of(_array[i]);
+                else
+                    std::swap(_array[kept++], _array[i]);
+            }
+        } catch(...) {
+            for (; i < _size; ++i)
+                std::swap(_array[kept++], _array[i]);
+            _size = kept;
+            rebuild_index();
+            throw;
+        }
+
+        const size_type removed = _size - kept;
+        _size = kept;
+
+        size_type capacity = _capacity;
+        while (capacity > 0 && capacity / 2 >= _size)
+            capacity = shrunk_capacity(capacity);
+        if (capacity != _capacity)
+            resize(capacity);
+        else if (removed != 0)
+            rebuild_index();
+
+        return removed;
+    }
+
+    /**
+        @brief Funzione che rimuove dal set gli elementi di una sequenza
+        identificata da un iteratore di inizio e uno di fine, con una sola
+        compattazione dell'array (vedi erase_if).
+
+        @param begin iteratore di inizio sequenza
+        @param end iteratore di fine sequenza
+
+        @return numero degli elementi rimossi
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    template <typename Iter>
+    size_type remove_all(Iter begin, Iter end) {
+        std::vector<value_type> values;
+        for (; begin != end; ++begin)
+            values.push_back(static_cast<value_type>(*begin));
+        if (values.empty() || _size == 0)
+            return 0;
+
+        typedef hash_index<value_type, Equal, Hash, size_type> index_type;
+        index_type index(static_cast<size_type>(values.size()));
+        for (size_type i = 0; i < values.size(); ++i)
+            index.insert(values.data(), i);
+
+        const value_type *data = values.data();
+        return erase_if([&index, data](const value_type &value) {
+            return index.find(data, value) != index_type::npos;
+        });
     }
 
     /**
@@ -285,26 +1875,61 @@ public:
         @return true se l'elemento è presente nel set, false altrimenti
     */
     bool contains(const value_type &value) const {
-        for (size_type i = 0; i < _size; ++i) {
-            if (_eql(_array[i], value))
-                return true;
-        }
-        return false;
+        return index_of(value) != _size;
+    }
+
+    /**
+        @brief Funzione che ritorna il digest del set, cioè la somma degli
+        hash (mescolati) dei suoi elementi. Non dipende dall'ordine degli
+        elementi ed è aggiornato ad ogni add/remove, quindi può essere
+        usato come chiave di cache. Con null_hash dipende solo dalla size.
+
+        @return digest del set
+    */
+    std::size_t digest(void) const {
+        if constexpr (hashed)
+            return _digest;
+        else
+            return static_cast<std::size_t>(_size) * mix_hash(0);
     }
 
     /**
         @brief Funzione che controlla se due set sono uguali (contengolo gli stessi elementi).
+        Set con size o digest diversi vengono scartati in O(1), altrimenti
+        il confronto costa O(N) atteso se è stato fornito un Hash.
 
         @param set reference costante del set da controllare
 
         @return true se i set contengolo gli stessi elementi, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
     */
     bool operator==(const set &other) const {
-        if (this->_size != other._size)
+        if (this->_size != other._size || this->digest() != other.digest())
             return false;
-        
+
+        if (!hashed) {
+            for (size_type i = 0; i < _size; i++) {
+                if (!this->contains(other[i]))
+                    return false;
+            }
+            return true;
+        }
+
+        if (indexed()) {
+            for (size_type i = 0; i < _size; i++) {
+                if (_index.find(_array, other._array[i]) == index_type::npos)
+                    return false;
+            }
+            return true;
+        }
+
+        hash_index<T, Equal, Hash, SizeT> index(_size);
+        for (size_type i = 0; i < _size; i++)
+            index.insert(_array, i);
+
         for (size_type i = 0; i < _size; i++) {
-            if (!this->contains(other[i]))
+            if (index.find(_array, other._array[i]) == index.npos)
                 return false;
         }
         
@@ -334,6 +1959,9 @@ public:
         return _array + _size;
     }
 
+    template <typename Iter>
+    friend typename std::iterator_traits<Iter>::value_type union_all(Iter begin, Iter end);
+
     /**
         @brief Funzione GLOBALE che implementa l'operatore di stream.
         La funzione è templata sul set ed è messa
@@ -345,6 +1973,9 @@ public:
         @return lo stream di output
     */
     friend std::ostream& operator<<(std::ostream &os, const set &ol) {
+        if (fast_writable<value_type>::value && fast_writable<size_type>::value && output_buffer::default_format(os))
+            return ol.write_buffered(os, std::integral_constant<bool, fast_writable<value_type>::value>());
+
         os << ol._size;
 
         for (size_type i = 0; i < ol._size; ++i) {
@@ -353,6 +1984,33 @@ public:
 
         return os;
     }
+
+private:
+    /**
+        @brief Funzione di supporto che scrive il set su uno stream tramite
+        output_buffer, con gli stessi byte dell'operatore di stream.
+
+        @param os stream di output
+
+        @return lo stream di output
+    */
+    std::ostream& write_buffered(std::ostream &os, std::true_type) const {
+        output_buffer out(os);
+        out.write_value(_size);
+
+        for (size_type i = 0; i < _size; ++i) {
+            out.write(" (", 2);
+            out.write_value(_array[i]);
+            out.write(")", 1);
+        }
+
+        out.flush();
+        return os;
+    }
+
+    std::ostream& write_buffered(std::ostream &os, std::false_type) const {
+        return os;
+    }
 };
 
 /**
@@ -368,10 +2026,10 @@ public:
     @throw std::bad_alloc possibile eccezione di allocazione
     @throw possibile eccezione dal predicato
 */
-template<typename T, typename Equal, typename Predicate>
-set<T, Equal> filter_out(const set<T, Equal> &setToFilter, const Predicate &predicate) {
-    set<T, Equal> tmp;
-    typename set<T, Equal>::const_iterator currIter = setToFilter.begin();
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage, typename Predicate>
+set<T, Equal, Hash, SizeT, Storage> filter_out(const set<T, Equal, Hash, SizeT, Storage> &setToFilter, const Predicate &predicate) {
+    set<T, Equal, Hash, SizeT, Storage> tmp;
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = setToFilter.begin();
 
     for (; currIter != setToFilter.end(); ++currIter) {
         if (predicate(*currIter))
@@ -391,11 +2049,11 @@ set<T, Equal> filter_out(const set<T, Equal> &setToFilter, const Predicate &pred
 
     @throw std::bad_alloc possibile eccezione di allocazione
 */
-template<typename T, typename Equal>
-set<T, Equal> operator+(const set<T, Equal> &lhs, const set<T, Equal> &rhs) {
-    set<T, Equal> tmp = lhs;
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+set<T, Equal, Hash, SizeT, Storage> operator+(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    set<T, Equal, Hash, SizeT, Storage> tmp = lhs;
 
-    typename set<T, Equal>::const_iterator currIter = rhs.begin();
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = rhs.begin();
     for (; currIter != rhs.end(); ++currIter)
         tmp.add(*currIter);
 
@@ -413,11 +2071,11 @@ set<T, Equal> operator+(const set<T, Equal> &lhs, const set<T, Equal> &rhs) {
     
     @throw std::bad_alloc possibile eccezione di allocazione
 */
-template<typename T, typename Equal>
-set<T, Equal> operator-(const set<T, Equal> &lhs, const set<T, Equal> &rhs) {
-    set<T, Equal> tmp;
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+set<T, Equal, Hash, SizeT, Storage> operator-(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    set<T, Equal, Hash, SizeT, Storage> tmp;
 
-    typename set<T, Equal>::const_iterator currIter = rhs.begin();
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = rhs.begin();
     for (; currIter != rhs.end(); ++currIter)
         if (lhs.contains(*currIter))
             tmp.add(*currIter);
@@ -425,6 +2083,194 @@ set<T, Equal> operator-(const set<T, Equal> &lhs, const set<T, Equal> &rhs) {
     return tmp;
 }
 
+/**
+    @brief Funzione GLOBALE che ritorna l'unione di una sequenza di set.
+    Il set risultato viene allocato una sola volta (con capacità pari alla
+    somma delle size) e i duplicati vengono scartati con un unico indice
+    hash, in O(N) atteso sul totale degli elementi se il set ha un Hash.
+    Se c'erano duplicati array e indice vengono poi ridotti alla size
+    del risultato.
+
+    @param begin iteratore (almeno forward) al primo set
+    @param end iteratore alla fine della sequenza di set
+
+    @return il set con gli elementi presenti in almeno un set
+
+    @throw std::bad_alloc possibile eccezione di allocazione
+    @throw std::length_error se la somma delle size supera max_size()
+*/
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type union_all(Iter begin, Iter end) {
+    typedef typename std::iterator_traits<Iter>::value_type set_type;
+    typedef typename set_type::size_type size_type;
+    typedef typename set_type::value_type value_type;
+
+    std::size_t total = 0;
+    for (Iter curr = begin; curr != end; ++curr)
+        total += curr->size();
+
+    set_type tmp;
+    if (total == 0)
+        return tmp;
+    if (total > tmp.max_size())
+        throw std::length_error("set: troppi elementi");
+
+    set_type result(static_cast<size_type>(total));
+    hash_index<value_type, typename set_type::equal_type, typename set_type::hash_type, size_type> index(result._capacity);
+
+    for (Iter curr = begin; curr != end; ++curr) {
+        for (size_type i = 0; i < curr->size(); ++i) {
+            result._array[result._size] = (*curr)[i];
+            if (index.insert(result._array, result._size)) {
+                result._digest += result.digest_of(result._array[result._size]);
+                ++result._size;
+            }
+        }
+    }
+
+    result._index.swap(index);
+    result._lookups.store(set_type::index_ready, std::memory_order_relaxed);
+    if (result._size < result._capacity)
+        result.resize(result._size);
+    else
+        result.adapt();
+    return result;
+}
+
+/**
+    @brief Funzione GLOBALE che ritorna l'intersezione di una sequenza di set.
+    Parte dal set più piccolo e lo filtra con ogni altro set, fermandosi
+    appena il risultato è vuoto. Le ricerche usano contains (indice
+    adattivo, layout congelato o scansione di un set piccolo); solo per
+    un set con Hash ma ancora senza indice si costruisce un indice
+    temporaneo.
+
+    @param begin iteratore (almeno forward) al primo set
+    @param end iteratore alla fine della sequenza di set
+
+    @return il set con gli elementi presenti in tutti i set
+
+    @throw std::bad_alloc possibile eccezione di allocazione
+*/
+template <typename Iter>
+typename std::iterator_traits<Iter>::value_type intersect_all(Iter begin, Iter end) {
+    typedef typename std::iterator_traits<Iter>::value_type set_type;
+    typedef typename set_type::size_type size_type;
+    typedef typename set_type::value_type value_type;
+    typedef hash_index<value_type, typename set_type::equal_type, typename set_type::hash_type, size_type> index_type;
+
+    if (begin == end)
+        return set_type();
+
+    Iter smallest = begin;
+    for (Iter curr = begin; curr != end; ++curr) {
+        if (curr->size() < smallest->size())
+            smallest = curr;
+    }
+
+    set_type result(*smallest);
+    for (Iter curr = begin; curr != end && result.size() != 0; ++curr) {
+        if (curr == smallest)
+            continue;
+
+        if (std::is_same<typename set_type::hash_type, null_hash>::value || curr->indexed() ||
+            curr->frozen() || curr->size() < ADAPTIVE_INDEX_MIN) {
+            const set_type &other = *curr;
+            result.erase_if([&other](const value_type &value) {
+                return !other.contains(value);
+            });
+            continue;
+        }
+
+        const value_type *data = curr->begin();
+        index_type index(curr->size());
+        for (size_type i = 0; i < curr->size(); ++i)
+            index.insert(data, i);
+
+        result.erase_if([&index, data](const value_type &value) {
+            return index.find(data, value) == index_type::npos;
+        });
+    }
+
+    return result;
+}
+
+/**
+    @brief Funzione GLOBALE che ritorna il numero di elementi comuni ai due
+    set, cioè (lhs - rhs).size(), senza costruire l'intersezione: scorre il
+    set più piccolo e cerca ogni elemento nel più grande.
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return numero di elementi comuni ai due set
+*/
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+typename set<T, Equal, Hash, SizeT, Storage>::size_type intersection_size(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    const set<T, Equal, Hash, SizeT, Storage> &smaller = lhs.size() <= rhs.size() ? lhs : rhs;
+    const set<T, Equal, Hash, SizeT, Storage> &larger = lhs.size() <= rhs.size() ? rhs : lhs;
+
+    typename set<T, Equal, Hash, SizeT, Storage>::size_type count = 0;
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = smaller.begin();
+    for (; currIter != smaller.end(); ++currIter)
+        if (larger.contains(*currIter))
+            ++count;
+
+    return count;
+}
+
+/**
+    @brief Funzione GLOBALE che ritorna il numero di elementi dell'unione
+    dei due set, cioè (lhs + rhs).size(), senza costruire l'unione.
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return numero di elementi dell'unione dei due set
+*/
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+std::size_t union_size(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    return static_cast<std::size_t>(lhs.size()) + rhs.size() - intersection_size(lhs, rhs);
+}
+
+/**
+    @brief Funzione GLOBALE che ritorna l'indice di Jaccard dei due set,
+    |lhs ∩ rhs| / |lhs ∪ rhs|, senza allocare.
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return similarità tra 0 e 1 (1 se entrambi i set sono vuoti)
+*/
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+double jaccard(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    const std::size_t common = intersection_size(lhs, rhs);
+    const std::size_t all = static_cast<std::size_t>(lhs.size()) + rhs.size() - common;
+    return all == 0 ? 1.0 : static_cast<double>(common) / static_cast<double>(all);
+}
+
+/**
+    @brief Funzione GLOBALE che controlla se i due set hanno almeno un
+    elemento in comune, fermandosi al primo trovato.
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return true se i set hanno un elemento in comune, false altrimenti
+*/
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+bool intersects(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    const set<T, Equal, Hash, SizeT, Storage> &smaller = lhs.size() <= rhs.size() ? lhs : rhs;
+    const set<T, Equal, Hash, SizeT, Storage> &larger = lhs.size() <= rhs.size() ? rhs : lhs;
+
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = smaller.begin();
+    for (; currIter != smaller.end(); ++currIter)
+        if (larger.contains(*currIter))
+            return true;
+
+    return false;
+}
+
 /**
     @brief Funzione GLOBALE che scrive su un file passato
     come stringa il set passato di tipo string
@@ -434,8 +2280,8 @@ set<T, Equal> operator-(const set<T, Equal> &lhs, const set<T, Equal> &rhs) {
 
     @throw possibile eccezione dalla scrittura su file
 */
-template<typename Equal>
-void save(const set<std::string, Equal> &set, const std::string &file) {
+template<typename Equal, typename Hash, typename SizeT, typename Storage>
+void save(const set<std::string, Equal, Hash, SizeT, Storage> &set, const std::string &file) {
     std::ofstream FILE;
     try {
         FILE.open(file);
@@ -450,4 +2296,154 @@ void save(const set<std::string, Equal> &set, const std::string &file) {
     }
 }
 
+/**
+  @brief Classe di supporto: streambuf che scrive su un std::FILE.
+*/
+class file_streambuf : public std::streambuf {
+    std::FILE *_file;
+
+protected:
+    int_type overflow(int_type c) {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+            return traits_type::not_eof(c);
+        return std::fputc(c, _file) == EOF ? traits_type::eof() : c;
+    }
+
+    std::streamsize xsputn(const char *data, std::streamsize count) {
+        return static_cast<std::streamsize>(std::fwrite(data, 1, static_cast<std::size_t>(count), _file));
+    }
+
+public:
+    explicit file_streambuf(std::FILE *file) : _file(file) {}
+};
+
+/**
+    @brief Funzione GLOBALE di supporto che crea un file temporaneo con un
+    nome unico accanto a file (file.tmp.<pid>.<contatore>), così scritture
+    concorrenti sullo stesso file non condividono il temporaneo.
+
+    @param file file di destinazione
+    @param tmp nome del file temporaneo creato
+
+    @return file temporaneo aperto in scrittura, nullptr se la creazione fallisce
+*/
+inline std::FILE* open_temporary(const std::string &file, std::string &tmp) {
+    static std::atomic<unsigned long> counter(0);
+    const unsigned long id = counter.fetch_add(1, std::memory_order_relaxed);
+#if defined(__unix__) || defined(__APPLE__)
+    tmp = file + ".tmp." + std::to_string(getpid()) + "." + std::to_string(id);
+    const int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0)
+        return nullptr;
+    std::FILE *out = fdopen(fd, "wb");
+    if (out == nullptr) {
+        close(fd);
+        std::remove(tmp.c_str());
+    }
+    return out;
+#else
+    tmp = file + ".tmp." + std::to_string(id);
+    return std::fopen(tmp.c_str(), "wb");
+#endif
+}
+
+/**
+    @brief Funzione GLOBALE che scrive un file in modo atomico: scrive su
+    un file temporaneo unico (vedi open_temporary), lo sincronizza su disco
+    (fsync dove disponibile) e lo rinomina in file, così file contiene
+    sempre una scrittura completa. Con più scritture concorrenti sullo
+    stesso file vince l'ultima rinominata.
+
+    @param file file su cui scrivere
+    @param writer funtore chiamato con lo stream (std::ostream&) del file
+
+    @throw std::runtime_error se la scrittura fallisce
+    @throw possibile eccezione dal funtore
+*/
+template<typename Writer>
+void write_atomic(const std::string &file, const Writer &writer) {
+    std::string tmp;
+    std::FILE *out = open_temporary(file, tmp);
+    if (out == nullptr)
+        throw std::runtime_error("save: impossibile aprire " + tmp);
+
+    bool ok = false;
+    try {
+        file_streambuf buffer(out);
+        std::ostream os(&buffer);
+        writer(os);
+        ok = os.good() && std::fflush(out) == 0;
+#if defined(__unix__) || defined(__APPLE__)
+        ok = ok && fsync(fileno(out)) == 0;
+#endif
+    } catch(...) {
+        std::fclose(out);
+        std::remove(tmp.c_str());
+        throw;
+    }
+
+    ok = std::fclose(out) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), file.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("save: impossibile scrivere " + file);
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    const std::string::size_type slash = file.find_last_of('/');
+    const std::string dir = slash == std::string::npos ? std::string(".") : file.substr(0, slash + 1);
+    const int fd = open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+#endif
+}
+
+/**
+    @brief Funzione GLOBALE che scrive un set su file in modo atomico
+    (vedi write_atomic).
+
+    @param set set da scrivere su un file
+    @param file file su cui scrivere
+
+    @throw std::runtime_error se la scrittura fallisce
+    @throw std::bad_alloc possibile eccezione di allocazione
+*/
+template<typename Set>
+void save_atomic(const Set &set, const std::string &file) {
+    write_atomic(file, [&set](std::ostream &os) {
+        os << set;
+    });
+}
+
+/**
+    @brief Funzione GLOBALE che salva il set di tipo string su file in
+    background. Il set viene copiato subito (istantanea), quindi dopo il
+    ritorno il chiamante può continuare a modificarlo; la scrittura avviene
+    su un altro thread con save_atomic. La copia è completa, O(N) sul
+    thread chiamante (indice compreso): per un'istantanea in O(1) usare
+    cow_set e il suo save_async.
+
+    Il future va conservato: se viene scartato, il suo distruttore
+    attende la fine della scrittura.
+
+    @param set set da scrivere su un file
+    @param file file su cui scrivere
+
+    @return future che diventa pronto a scrittura completata e
+    rilancia le eventuali eccezioni della scrittura
+
+    @throw std::bad_alloc possibile eccezione di allocazione
+    @throw std::system_error se non è possibile creare il thread
+*/
+template<typename Equal, typename Hash, typename SizeT, typename Storage>
+[[nodiscard]] std::future<void> save_async(const set<std::string, Equal, Hash, SizeT, Storage> &set, const std::string &file) {
+    typedef ::set<std::string, Equal, Hash, SizeT, Storage> set_type;
+    std::shared_ptr<const set_type> snapshot = std::make_shared<const set_type>(set);
+
+    return std::async(std::launch::async, [snapshot, file]() {
+        save_atomic(*snapshot, file);
+    });
+}
+
 #endif // SET_HPP
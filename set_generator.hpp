@@ -0,0 +1,365 @@
+/**
+  @file set_generator.hpp
+
+  @brief File header della classe set_generator templata
+
+  File di dichiarazioni/definizioni della classe set_generator, un generatore
+  C++20 (coroutine) che produce gli elementi risultato delle operazioni sui
+  set uno alla volta, e delle versioni in streaming di operator+, operator-
+  e filter_out
+*/
+
+#ifndef SET_GENERATOR_HPP
+#define SET_GENERATOR_HPP
+
+#if !defined(__cpp_impl_coroutine)
+#error "set_generator.hpp richiede le coroutine del C++20 (-std=c++20)"
+#endif
+
+#include <coroutine> // std::coroutine_handle, std::suspend_always
+#include <cstdio> // std::remove
+#include <exception> // std::exception_ptr
+#include <fstream> // std::ofstream, std::ifstream
+#include <iterator> // std::input_iterator_tag
+#include <memory> // std::addressof
+#include <string> // std::string
+#include "set.hpp"
+
+/**
+  @brief classe generatore di elementi
+
+  La classe è il tipo di ritorno delle coroutine che producono elementi con
+  co_yield. Gli elementi vengono calcolati solo quando l'iteratore avanza:
+  la memoria usata è quella della coroutine, indipendente dal numero di
+  elementi prodotti. Distruggere il generatore prima della fine interrompe
+  la produzione (cancellazione). Il generatore è percorribile una sola volta
+  e non è copiabile.
+*/
+template <typename T>
+class set_generator {
+public:
+    /**
+        TypeDef del tipo prodotto dal generatore
+    */
+    typedef T value_type;
+
+    /**
+        Promise della coroutine: conserva l'ultimo elemento prodotto
+        (per indirizzo, l'elemento vive finché la coroutine è sospesa)
+        e l'eventuale eccezione da rilanciare a chi consuma.
+    */
+    struct promise_type {
+        const value_type* _current = nullptr;
+        std::exception_ptr _exception;
+
+        set_generator get_return_object() {
+            return set_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always yield_value(const value_type &value) noexcept {
+            _current = std::addressof(value);
+            return {};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() {
+            _exception = std::current_exception();
+        }
+
+        // il generatore produce solo con co_yield
+        template <typename U>
+        std::suspend_never await_transform(U &&value) = delete;
+    };
+
+private:
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    handle_type _handle;
+
+    explicit set_generator(handle_type handle) : _handle(handle) {}
+
+    /**
+        @brief Funzione di supporto che riprende la coroutine fino al
+        prossimo elemento, rilanciando l'eventuale eccezione.
+
+        @param handle coroutine da riprendere
+    */
+    static void advance(handle_type handle) {
+        handle.resume();
+        if (handle.done() && handle.promise()._exception) {
+            std::exception_ptr exception = handle.promise()._exception;
+            handle.promise()._exception = nullptr;
+            std::rethrow_exception(exception);
+        }
+    }
+
+public:
+    /**
+        @brief Iteratore di input sugli elementi prodotti
+    */
+    class const_iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef T                       value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef const T*                pointer;
+        typedef const T&                reference;
+
+        const_iterator() : _handle(nullptr) {}
+
+        reference operator*() const {
+            return *_handle.promise()._current;
+        }
+
+        pointer operator->() const {
+            return _handle.promise()._current;
+        }
+
+        const_iterator& operator++() {
+            advance(_handle);
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return finished() == other.finished();
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return !(*this == other);
+        }
+
+    private:
+        handle_type _handle; // nullptr per l'iteratore di fine
+
+        friend class set_generator;
+
+        explicit const_iterator(handle_type handle) : _handle(handle) {}
+
+        bool finished(void) const {
+            return !_handle || _handle.done();
+        }
+    };
+
+    /**
+        @brief Move constructor.
+
+        @param other generatore da spostare
+    */
+    set_generator(set_generator &&other) noexcept : _handle(other._handle) {
+        other._handle = nullptr;
+    }
+
+    /**
+        @brief Move assignment, interrompe la produzione corrente.
+
+        @param other generatore da spostare
+
+        @return reference al generatore this
+    */
+    set_generator& operator=(set_generator &&other) noexcept {
+        if (this != &other) {
+            if (_handle)
+                _handle.destroy();
+            _handle = other._handle;
+            other._handle = nullptr;
+        }
+        return *this;
+    }
+
+    set_generator(const set_generator &other) = delete;
+    set_generator& operator=(const set_generator &other) = delete;
+
+    /**
+        @brief Distruttore, interrompe la produzione se non è terminata.
+    */
+    ~set_generator() {
+        if (_handle)
+            _handle.destroy();
+    }
+
+    /**
+        @brief Funzione che avvia la produzione e ritorna l'iteratore al
+        primo elemento. Va chiamata una sola volta.
+
+        @return iteratore al primo elemento
+
+        @throw possibile eccezione dalla coroutine
+    */
+    const_iterator begin(void) {
+        if (_handle && !_handle.done())
+            advance(_handle);
+        return const_iterator(_handle);
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore di fine.
+
+        @return iteratore di fine
+    */
+    const_iterator end(void) {
+        return const_iterator();
+    }
+};
+
+/**
+    @brief Funzione GLOBALE che produce in streaming gli elementi che
+    soddisfano il predicato (vedi filter_out).
+
+    @param setToFilter set su cui applicare il predicato
+    @param predicate predicato da applicare ad ogni elemento del set
+
+    @return generatore degli elementi che soddisfano il predicato
+
+    @pre setToFilter non deve essere distrutto o modificato finché il
+    generatore è in uso
+*/
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage, typename Predicate>
+set_generator<T> filter_out_stream(const set<T, Equal, Hash, SizeT, Storage> &setToFilter, Predicate predicate) {
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = setToFilter.begin();
+
+    for (; currIter != setToFilter.end(); ++currIter) {
+        if (predicate(*currIter))
+            co_yield *currIter;
+    }
+}
+
+/**
+    @brief Funzione GLOBALE che produce in streaming gli elementi di un
+    generatore che soddisfano il predicato, per concatenare le operazioni.
+
+    @param source generatore da filtrare
+    @param predicate predicato da applicare ad ogni elemento
+
+    @return generatore degli elementi che soddisfano il predicato
+*/
+template<typename T, typename Predicate>
+set_generator<T> filter_out_stream(set_generator<T> source, Predicate predicate) {
+    typename set_generator<T>::const_iterator currIter = source.begin();
+
+    for (; currIter != source.end(); ++currIter) {
+        if (predicate(*currIter))
+            co_yield *currIter;
+    }
+}
+
+/**
+    @brief Funzione GLOBALE che produce in streaming gli elementi
+    dell'unione dei due set, nello stesso ordine di operator+,
+    senza costruire il set risultato.
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return generatore degli elementi dell'unione
+
+    @pre lhs e rhs non devono essere distrutti o modificati finché il
+    generatore è in uso
+*/
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+set_generator<T> union_stream(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = lhs.begin();
+    for (; currIter != lhs.end(); ++currIter)
+        co_yield *currIter;
+
+    for (currIter = rhs.begin(); currIter != rhs.end(); ++currIter)
+        if (!lhs.contains(*currIter))
+            co_yield *currIter;
+}
+
+/**
+    @brief Funzione GLOBALE che produce in streaming gli elementi
+    dell'intersezione dei due set, nello stesso ordine di operator-,
+    senza costruire il set risultato.
+
+    @param lhs set di sinistra
+    @param rhs set di destra
+
+    @return generatore degli elementi comuni ai due set
+
+    @pre lhs e rhs non devono essere distrutti o modificati finché il
+    generatore è in uso
+*/
+template<typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+set_generator<T> intersection_stream(const set<T, Equal, Hash, SizeT, Storage> &lhs, const set<T, Equal, Hash, SizeT, Storage> &rhs) {
+    typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = rhs.begin();
+    for (; currIter != rhs.end(); ++currIter)
+        if (lhs.contains(*currIter))
+            co_yield *currIter;
+}
+
+/**
+    @brief Funzione GLOBALE che salva su file gli elementi prodotti da un
+    generatore di string, nello stesso formato di save (numero di elementi
+    seguito dagli elementi). Poiché il numero è noto solo alla fine, gli
+    elementi passano da un file temporaneo unico (vedi open_temporary): la
+    memoria usata non dipende dal numero di elementi. La scrittura finale è atomica (vedi write_atomic).
+
+    @param source generatore degli elementi da salvare
+    @param file file su cui scrivere
+
+    @return numero di elementi salvati
+
+    @throw std::runtime_error se la scrittura fallisce
+    @throw possibile eccezione dal generatore
+*/
+inline std::size_t save(set_generator<std::string> source, const std::string &file) {
+    std::string body;
+    std::FILE *bodyFile = open_temporary(file + ".body", body);
+    if (bodyFile == nullptr)
+        throw std::runtime_error("save: impossibile aprire " + body);
+    std::size_t count = 0;
+
+    try {
+        bool ok;
+        try {
+            file_streambuf bodyBuffer(bodyFile);
+            std::ostream out(&bodyBuffer);
+            output_buffer buffer(out);
+            set_generator<std::string>::const_iterator currIter = source.begin();
+            for (; currIter != source.end(); ++currIter, ++count) {
+                buffer.write(" (", 2);
+                buffer.write_value(*currIter);
+                buffer.write(")", 1);
+            }
+            buffer.flush();
+            ok = out.good();
+        } catch(...) {
+            std::fclose(bodyFile);
+            throw;
+        }
+        if (std::fclose(bodyFile) != 0 || !ok)
+            throw std::runtime_error("save: impossibile scrivere " + body);
+
+        write_atomic(file, [&body, count](std::ostream &os) {
+            std::ifstream in(body, std::ios::binary);
+            if (!in.is_open())
+                throw std::runtime_error("save: impossibile leggere " + body);
+            os << count;
+            if (in.peek() != std::ifstream::traits_type::eof())
+                os << in.rdbuf();
+            if (in.bad())
+                throw std::runtime_error("save: impossibile leggere " + body);
+        });
+    } catch(...) {
+        std::remove(body.c_str());
+        throw;
+    }
+
+    std::remove(body.c_str());
+    return count;
+}
+
+#endif // SET_GENERATOR_HPP
@@ -0,0 +1,232 @@
+/**
+  @file set_sketch.hpp
+
+  @brief File header della classe minhash_sketch templata
+
+  File di dichiarazioni/definizioni della classe minhash_sketch, un riassunto
+  di dimensione fissa di un set per stimare cardinalità e similarità
+*/
+
+#ifndef SET_SKETCH_HPP
+#define SET_SKETCH_HPP
+
+#include <algorithm> // std::lower_bound, std::copy_backward
+#include <array> // std::array
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <limits> // std::numeric_limits
+#include <type_traits> // std::is_same
+#include "set.hpp"
+
+/**
+  @brief classe sketch MinHash (bottom-k)
+
+  La classe conserva i K hash più piccoli (distinti) degli elementi di un
+  set. Da due sketch si stimano in O(K) la cardinalità dell'unione, quella
+  dell'intersezione e l'indice di Jaccard, con errore relativo dell'ordine
+  di 1/sqrt(K). Se il set ha al massimo K elementi le risposte sono esatte
+  (a meno di collisioni di hash).
+
+  Lo sketch non supporta la rimozione: va ricostruito dal set quando
+  serve, in O(N), e può essere riusato per tutti i confronti successivi.
+  Il set deve avere un Hash diverso da null_hash.
+*/
+template <std::size_t K = 256>
+class minhash_sketch {
+public:
+    typedef std::size_t size_type;
+    typedef std::size_t hash_type;
+
+private:
+    std::array<hash_type, K> _hashes; // hash ordinati in modo crescente
+    size_type _count;
+    bool _truncated; // true se almeno un hash è stato scartato
+
+public:
+    /**
+        @brief Costruttore di default, sketch di un set vuoto.
+    */
+    minhash_sketch() : _hashes(), _count(0), _truncated(false) {}
+
+    /**
+        @brief Costruttore che riassume un set.
+
+        @param source set da riassumere
+    */
+    template <typename T, typename Equal, typename Hash, typename SizeT, typename Storage>
+    explicit minhash_sketch(const set<T, Equal, Hash, SizeT, Storage> &source) : _hashes(), _count(0), _truncated(false) {
+        static_assert(!std::is_same<Hash, null_hash>::value, "minhash_sketch: serve un Hash diverso da null_hash");
+
+        const Hash hash = Hash();
+        typename set<T, Equal, Hash, SizeT, Storage>::const_iterator currIter = source.begin();
+        for (; currIter != source.end(); ++currIter)
+            insert(mix_hash(hash(*currIter)));
+    }
+
+    /**
+        @brief Funzione che aggiunge un hash allo sketch, se è tra i K
+        più piccoli.
+
+        @param h hash (già mescolato) da aggiungere
+    */
+    void insert(hash_type h) {
+        if (_count == K && h >= _hashes[K - 1]) {
+            if (h != _hashes[K - 1])
+                _truncated = true;
+            return;
+        }
+
+        hash_type *end = _hashes.data() + _count;
+        hash_type *position = std::lower_bound(_hashes.data(), end, h);
+        if (position != end && *position == h)
+            return;
+
+        if (_count < K)
+            ++_count;
+        else
+            _truncated = true; // l'hash più grande esce dallo sketch
+        std::copy_backward(position, _hashes.data() + _count - 1, _hashes.data() + _count);
+        *position = h;
+    }
+
+    /**
+        @brief Funzione che ritorna il numero di hash nello sketch.
+
+        @return numero di hash (al massimo K)
+    */
+    size_type size(void) const {
+        return _count;
+    }
+
+    /**
+        @brief Funzione che ritorna se lo sketch contiene tutti gli hash del
+        set riassunto, cioè se le stime sono esatte.
+
+        @return true se nessun hash è stato scartato (il set riassunto ha
+        al massimo K elementi)
+    */
+    bool exact(void) const {
+        return !_truncated;
+    }
+
+    /**
+        @brief Funzione che ritorna un hash dello sketch.
+
+        @param index posizione dell'hash
+
+        @return hash in posizione index (in ordine crescente)
+
+        @pre index < size()
+    */
+    hash_type operator[](size_type index) const {
+        assert(index < _count);
+        return _hashes[index];
+    }
+
+    /**
+        @brief Funzione che controlla se lo sketch contiene un hash.
+
+        @param h hash da cercare
+
+        @return true se l'hash è presente, false altrimenti
+    */
+    bool contains(hash_type h) const {
+        const hash_type *end = _hashes.data() + _count;
+        const hash_type *position = std::lower_bound(_hashes.data(), end, h);
+        return position != end && *position == h;
+    }
+
+    /**
+        @brief Funzione che stima il numero di elementi del set riassunto.
+
+        @return numero stimato di elementi
+    */
+    double estimate_size(void) const {
+        if (exact())
+            return static_cast<double>(_count);
+
+        const double range = static_cast<double>(std::numeric_limits<hash_type>::max()) + 1.0;
+        return static_cast<double>(K - 1) * range / (static_cast<double>(_hashes[K - 1]) + 1.0);
+    }
+
+    /**
+        @brief Funzione GLOBALE che ritorna lo sketch dell'unione dei due
+        set riassunti (i K hash più piccoli dei due sketch).
+
+        @param lhs sketch di sinistra
+        @param rhs sketch di destra
+
+        @return sketch dell'unione
+    */
+    friend minhash_sketch operator+(const minhash_sketch &lhs, const minhash_sketch &rhs) {
+        minhash_sketch result;
+        size_type l = 0, r = 0;
+        while (result._count < K && (l < lhs._count || r < rhs._count)) {
+            hash_type h;
+            if (r == rhs._count || (l < lhs._count && lhs._hashes[l] < rhs._hashes[r])) {
+                h = lhs._hashes[l++];
+            } else {
+                if (l < lhs._count && lhs._hashes[l] == rhs._hashes[r])
+                    ++l;
+                h = rhs._hashes[r++];
+            }
+            result._hashes[result._count++] = h;
+        }
+        result._truncated = lhs._truncated || rhs._truncated || l < lhs._count || r < rhs._count;
+        return result;
+    }
+};
+
+/**
+    @brief Funzione GLOBALE che stima l'indice di Jaccard dei due set
+    riassunti: la frazione degli hash dello sketch dell'unione presenti
+    in entrambi gli sketch.
+
+    @param lhs sketch di sinistra
+    @param rhs sketch di destra
+
+    @return similarità stimata tra 0 e 1 (1 se entrambi i set sono vuoti)
+*/
+template <std::size_t K>
+double jaccard(const minhash_sketch<K> &lhs, const minhash_sketch<K> &rhs) {
+    const minhash_sketch<K> all = lhs + rhs;
+    if (all.size() == 0)
+        return 1.0;
+
+    std::size_t common = 0;
+    for (std::size_t i = 0; i < all.size(); ++i)
+        if (lhs.contains(all[i]) && rhs.contains(all[i]))
+            ++common;
+
+    return static_cast<double>(common) / static_cast<double>(all.size());
+}
+
+/**
+    @brief Funzione GLOBALE che stima il numero di elementi dell'unione
+    dei due set riassunti.
+
+    @param lhs sketch di sinistra
+    @param rhs sketch di destra
+
+    @return numero stimato di elementi dell'unione
+*/
+template <std::size_t K>
+double union_size(const minhash_sketch<K> &lhs, const minhash_sketch<K> &rhs) {
+    return (lhs + rhs).estimate_size();
+}
+
+/**
+    @brief Funzione GLOBALE che stima il numero di elementi comuni ai due
+    set riassunti (Jaccard per la cardinalità dell'unione).
+
+    @param lhs sketch di sinistra
+    @param rhs sketch di destra
+
+    @return numero stimato di elementi comuni
+*/
+template <std::size_t K>
+double intersection_size(const minhash_sketch<K> &lhs, const minhash_sketch<K> &rhs) {
+    return jaccard(lhs, rhs) * union_size(lhs, rhs);
+}
+
+#endif // SET_SKETCH_HPP
@@ -0,0 +1,631 @@
+/**
+  @file string_set.hpp
+
+  @brief File header della classe string_set
+
+  File di dichiarazioni/definizioni della classe string_set, un set di
+  stringhe con i caratteri raccolti in un'unica area contigua (arena)
+*/
+
+#ifndef STRING_SET_HPP
+#define STRING_SET_HPP
+
+#include <cassert> // assert
+#include <cstdint> // std::uint32_t, std::uint64_t
+#include <cstring> // std::memcmp
+#include <fstream> // std::ofstream
+#include <functional> // std::hash, std::equal_to
+#include <iterator> // std::random_access_iterator_tag
+#include <limits> // std::numeric_limits
+#include <stdexcept> // std::length_error
+#include <string> // std::string
+#include <string_view> // std::string_view
+#include <vector> // std::vector
+#include "set.hpp"
+
+/**
+  @brief classe set di stringhe su arena
+
+  La classe implementa un set di stringhe (uguaglianza byte a byte) in cui
+  i caratteri di tutte le chiavi stanno in un unico buffer contiguo e ogni
+  elemento è uno slot di 16 byte con posizione e lunghezza nel buffer più
+  una parola di controllo (lunghezza e hash dei caratteri).
+  contains confronta prima le parole di controllo, che stanno nell'array
+  degli slot, e legge l'arena solo quando coincidono: niente allocazioni
+  per chiave e niente puntatori da seguire.
+  Come il set con un Hash, sotto ADAPTIVE_INDEX_SIZE elementi la ricerca è
+  una scansione lineare degli slot; da lì in poi un hash_index sulle parole
+  di controllo la rende a tempo costante atteso, finché la size non scende
+  sotto ADAPTIVE_INDEX_MIN.
+
+  Rimuovere un elemento lascia i suoi caratteri nell'arena, che viene
+  compattata quando i byte inutilizzati superano quelli in uso.
+  Come set, la rimozione sposta l'ultimo elemento al posto di quello rimosso.
+*/
+class string_set {
+public:
+    /**
+        TypeDef del tipo contenuto nel set
+    */
+    typedef std::string_view value_type;
+    typedef std::uint32_t size_type;
+
+private:
+    /**
+        Elemento del set: parola di controllo e posizione nell'arena
+    */
+    struct slot {
+        std::uint64_t tag;
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    /**
+        @brief Hash di uno slot per l'indice: la parola di controllo,
+        che contiene già l'hash dei caratteri.
+    */
+    struct slot_hash {
+        std::size_t operator()(const slot &s) const {
+            return static_cast<std::size_t>(s.tag);
+        }
+    };
+
+    /**
+        @brief Uguaglianza tra slot per l'indice: due slot dello stesso set
+        sono uguali solo se sono lo stesso slot. Le chiavi cercate
+        dall'esterno si confrontano con key_matches.
+    */
+    struct slot_equal {
+        bool operator()(const slot &a, const slot &b) const {
+            return a.tag == b.tag && a.offset == b.offset && a.length == b.length;
+        }
+    };
+
+    typedef hash_index<slot, slot_equal, slot_hash, size_type> index_type;
+
+    std::vector<slot> _slots;
+    std::vector<char> _arena;
+    std::size_t _dead_bytes; // byte dell'arena di elementi rimossi
+    index_type _index; // vuoto sotto ADAPTIVE_INDEX_SIZE elementi
+
+    /**
+        @brief Funzione di supporto che calcola la parola di controllo di
+        una chiave: lunghezza nei 32 bit alti, hash dei caratteri nei 32
+        bassi. L'hash distingue anche chiavi con un prefisso comune
+        (es. URL dello stesso sito) e serve da hash per l'indice.
+
+        @param key chiave
+
+        @return parola di controllo
+    */
+    static std::uint64_t tag_of(std::string_view key) {
+        const std::uint32_t hash = static_cast<std::uint32_t>(mix_hash(std::hash<std::string_view>()(key)));
+        return static_cast<std::uint64_t>(key.size()) << 32 | hash;
+    }
+
+    /**
+        @brief Funzione di supporto che controlla se uno slot contiene
+        una chiave.
+
+        @param s slot
+        @param tag parola di controllo della chiave
+        @param key chiave
+
+        @return true se lo slot contiene la chiave, false altrimenti
+    */
+    bool key_matches(const slot &s, std::uint64_t tag, std::string_view key) const {
+        return s.tag == tag && (key.empty() || std::memcmp(_arena.data() + s.offset, key.data(), key.size()) == 0);
+    }
+
+    /**
+        @brief Funzione di supporto che costruisce l'indice su tutti gli
+        slot, con spazio per la capacità del vettore degli slot.
+        L'indice è solo un'ottimizzazione: se manca la memoria il set
+        resta alla scansione lineare.
+    */
+    void build_index(void) {
+        try {
+            _index.reserve(static_cast<size_type>(_slots.capacity()));
+            for (size_type i = 0; i < size(); ++i)
+                _index.insert(_slots.data(), i);
+        } catch(const std::bad_alloc &) {
+            _index.clear();
+        }
+    }
+
+    /**
+        @brief Funzione di supporto che ritorna la chiave di uno slot.
+
+        @param s slot
+
+        @return vista sui caratteri della chiave nell'arena
+    */
+    std::string_view key_of(const slot &s) const {
+        return std::string_view(_arena.data() + s.offset, s.length);
+    }
+
+    /**
+        @brief Funzione di supporto che ricostruisce l'arena con i soli
+        caratteri degli elementi presenti.
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void compact_arena(void) {
+        std::vector<char> tmp;
+        tmp.reserve(_arena.size() - _dead_bytes);
+        for (std::size_t i = 0; i < _slots.size(); ++i) {
+            const std::string_view key = key_of(_slots[i]);
+            _slots[i].offset = static_cast<std::uint32_t>(tmp.size());
+            tmp.insert(tmp.end(), key.begin(), key.end());
+        }
+        _arena.swap(tmp);
+        _dead_bytes = 0;
+    }
+
+public:
+    /**
+        @brief Iteratore costante sulle chiavi, ritorna std::string_view
+    */
+    class const_iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef std::string_view                value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const std::string_view*         pointer;
+        typedef std::string_view                reference;
+
+        const_iterator() : _set(nullptr), _index(0) {}
+
+        reference operator*() const {
+            return (*_set)[_index];
+        }
+
+        reference operator[](difference_type n) const {
+            return (*_set)[static_cast<size_type>(_index + n)];
+        }
+
+        const_iterator& operator++() {
+            ++_index;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp(*this);
+            ++_index;
+            return tmp;
+        }
+
+        const_iterator& operator--() {
+            --_index;
+            return *this;
+        }
+
+        const_iterator operator--(int) {
+            const_iterator tmp(*this);
+            --_index;
+            return tmp;
+        }
+
+        const_iterator& operator+=(difference_type n) {
+            _index += n;
+            return *this;
+        }
+
+        const_iterator& operator-=(difference_type n) {
+            _index -= n;
+            return *this;
+        }
+
+        const_iterator operator+(difference_type n) const {
+            return const_iterator(_set, _index + n);
+        }
+
+        const_iterator operator-(difference_type n) const {
+            return const_iterator(_set, _index - n);
+        }
+
+        difference_type operator-(const const_iterator &other) const {
+            return _index - other._index;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return _index == other._index;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return _index != other._index;
+        }
+
+        bool operator<(const const_iterator &other) const {
+            return _index < other._index;
+        }
+
+        bool operator>(const const_iterator &other) const {
+            return _index > other._index;
+        }
+
+        bool operator<=(const const_iterator &other) const {
+            return _index <= other._index;
+        }
+
+        bool operator>=(const const_iterator &other) const {
+            return _index >= other._index;
+        }
+
+    private:
+        const string_set *_set;
+        difference_type _index;
+
+        friend class string_set;
+
+        const_iterator(const string_set *s, difference_type index) : _set(s), _index(index) {}
+    };
+
+    /**
+        @brief Costruttore di default.
+
+        @post size() == 0
+    */
+    string_set() : _dead_bytes(0) {}
+
+    /**
+        @brief Copy Constructor, ricostruisce l'eventuale indice.
+
+        @param other string_set da copiare
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    string_set(const string_set &other) : _slots(other._slots), _arena(other._arena), _dead_bytes(other._dead_bytes) {
+        if (!other._index.empty())
+            build_index();
+    }
+
+    /**
+        @brief Operatore di assegnamento.
+
+        @param other string_set da copiare
+
+        @return reference al string_set
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    string_set& operator=(const string_set &other) {
+        if (this != &other) {
+            string_set tmp(other);
+            this->swap(tmp);
+        }
+
+        return *this;
+    }
+
+    /**
+        @brief Costruttore che crea un set riempito con dei dati presi
+        da una sequenza identificata da un iteratore di inizio e uno di fine.
+
+        @param begin iteratore di inizio sequenza
+        @param end iteratore di fine sequenza
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw std::length_error se l'arena supera i 4GB
+    */
+    template <typename Iter>
+    string_set(Iter begin, Iter end) : _dead_bytes(0) {
+        for (; begin != end; ++begin)
+            add(std::string_view(*begin));
+    }
+
+    /**
+        @brief Funzione che svuota il set e dealloca la memoria allocata.
+
+        @post size() == 0
+    */
+    void clear(void) {
+        std::vector<slot>().swap(_slots);
+        std::vector<char>().swap(_arena);
+        _dead_bytes = 0;
+        _index.clear();
+    }
+
+    /**
+        @brief Funzione scambia lo stato tra l'istanza corrente
+        e quella passata come parametro.
+
+        @param other set con cui scambiare lo stato
+    */
+    void swap(string_set &other) {
+        _slots.swap(other._slots);
+        _arena.swap(other._arena);
+        std::swap(_dead_bytes, other._dead_bytes);
+        _index.swap(other._index);
+    }
+
+    /**
+        @brief Funzione che riserva spazio per un numero di chiavi e di
+        caratteri, per evitare riallocazioni durante un riempimento.
+
+        @param keys numero di chiavi
+        @param bytes numero totale di caratteri
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    void reserve(size_type keys, std::size_t bytes) {
+        const std::size_t capacity = _slots.capacity();
+        _slots.reserve(keys);
+        _arena.reserve(bytes);
+        if (!_index.empty() && _slots.capacity() != capacity)
+            build_index();
+    }
+
+    /**
+        @brief Funzione che ritorna il numero degli elementi del set.
+
+        @return numero degli elementi nel set
+    */
+    size_type size(void) const {
+        return static_cast<size_type>(_slots.size());
+    }
+
+    /**
+        @brief Funzione che ritorna se il set usa l'indice hash.
+
+        @return true se le ricerche usano l'indice, false se sono lineari
+    */
+    bool indexed(void) const {
+        return !_index.empty();
+    }
+
+    /**
+        @brief Funzione che ritorna il numero di caratteri nell'arena,
+        compresi quelli degli elementi rimossi non ancora compattati.
+
+        @return byte usati dall'arena
+    */
+    std::size_t arena_size(void) const {
+        return _arena.size();
+    }
+
+    /**
+        @brief Funzione che ritorna l'occupazione di memoria del set:
+        gli slot e l'indice come buffer, l'arena come memoria degli elementi.
+
+        @return occupazione di memoria in byte
+    */
+    set_memory_usage memory_usage(void) const {
+        set_memory_usage usage;
+        usage.buffer_bytes = _slots.capacity() * sizeof(slot) + _index.bytes();
+        usage.slack_bytes = (_slots.capacity() - _slots.size()) * sizeof(slot);
+        usage.deep_bytes = _arena.capacity();
+        return usage;
+    }
+
+    /**
+        @brief Operatore getter di un elemento del set.
+
+        @param index posizione dell'elemento da leggere
+        @return vista sui caratteri dell'elemento, valida fino alla
+        prossima modifica del set
+
+        @pre index < size()
+    */
+    std::string_view operator[](const size_type index) const {
+        assert(index < _slots.size());
+        return key_of(_slots[index]);
+    }
+
+    /**
+        @brief Funzione che cerca la posizione di un elemento.
+
+        @param value elemento da cercare
+
+        @return posizione dell'elemento nel set, size() se non presente
+    */
+    size_type index_of(std::string_view value) const {
+        const std::uint64_t tag = tag_of(value);
+        const slot *slots = _slots.data();
+        if (!_index.empty()) {
+            const size_type pos = _index.find_if(slots, static_cast<std::size_t>(tag), [&](const slot &s) {
+                return key_matches(s, tag, value);
+            });
+            return pos == index_type::npos ? size() : pos;
+        }
+
+        for (std::size_t i = 0; i < _slots.size(); ++i) {
+            if (key_matches(slots[i], tag, value))
+                return static_cast<size_type>(i);
+        }
+        return size();
+    }
+
+    /**
+        @brief Funzione che controlla la presenza di un elemento.
+
+        @param value elemento da controllare
+
+        @return true se l'elemento è presente nel set, false altrimenti
+    */
+    bool contains(std::string_view value) const {
+        return index_of(value) != size();
+    }
+
+    /**
+        @brief Funzione che aggiunge un elemento al set, copiandone i
+        caratteri nell'arena.
+
+        @param value elemento da aggiungere
+
+        @return true se aggiunto con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+        @throw std::length_error se l'arena supera i 4GB
+    */
+    bool add(std::string_view value) {
+        if (contains(value))
+            return false;
+        if (_slots.size() == std::numeric_limits<size_type>::max())
+            throw std::length_error("string_set: troppi elementi");
+        if (_arena.size() + value.size() > std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("string_set: arena piena");
+
+        slot s;
+        s.tag = tag_of(value);
+        s.offset = static_cast<std::uint32_t>(_arena.size());
+        s.length = static_cast<std::uint32_t>(value.size());
+
+        const std::size_t capacity = _slots.capacity();
+        _slots.push_back(s);
+        try {
+            _arena.insert(_arena.end(), value.begin(), value.end());
+        } catch(...) {
+            _slots.pop_back();
+            throw;
+        }
+
+        if (!_index.empty() && _slots.capacity() == capacity)
+            _index.insert(_slots.data(), size() - 1);
+        else if (!_index.empty() || size() >= ADAPTIVE_INDEX_SIZE)
+            build_index();
+        return true;
+    }
+
+    /**
+        @brief Funzione che rimuove un elemento dal set.
+
+        @param value elemento da rimuovere
+
+        @return true se rimosso con successo, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool remove(std::string_view value) {
+        const size_type index = index_of(value);
+        if (index == size())
+            return false;
+
+        const size_type last = size() - 1;
+        if (!_index.empty()) {
+            _index.erase(_slots.data(), index);
+            if (index != last)
+                _index.relocate(_slots.data(), last, index);
+        }
+
+        _dead_bytes += _slots[index].length;
+        _slots[index] = _slots.back();
+        _slots.pop_back();
+        if (!_index.empty() && size() < ADAPTIVE_INDEX_MIN)
+            _index.clear();
+
+        if (_dead_bytes > _arena.size() - _dead_bytes)
+            compact_arena();
+        return true;
+    }
+
+    /**
+        @brief Funzione che controlla se due set sono uguali. Cerca con
+        contains se other ha l'indice o meno di ADAPTIVE_INDEX_MIN elementi,
+        altrimenti indicizza le chiavi di other con un hash_index
+        temporaneo: O(N) atteso.
+
+        @param other set da controllare
+
+        @return true se i set contengono gli stessi elementi, false altrimenti
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+    */
+    bool operator==(const string_set &other) const {
+        if (size() != other.size())
+            return false;
+
+        if (size() < ADAPTIVE_INDEX_MIN || other.indexed()) {
+            for (size_type i = 0; i < size(); ++i)
+                if (!other.contains((*this)[i]))
+                    return false;
+            return true;
+        }
+
+        typedef hash_index<std::string_view, std::equal_to<std::string_view>,
+                           std::hash<std::string_view>, size_type> view_index_type;
+        const std::vector<std::string_view> keys(other.begin(), other.end());
+        view_index_type index(other.size());
+        for (size_type i = 0; i < other.size(); ++i)
+            index.insert(keys.data(), i);
+
+        for (size_type i = 0; i < size(); ++i)
+            if (index.find(keys.data(), (*this)[i]) == view_index_type::npos)
+                return false;
+        return true;
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore all'inizio della sequenza dati.
+
+        @return iteratore all'inizio della sequenza dati
+    */
+    const_iterator begin(void) const {
+        return const_iterator(this, 0);
+    }
+
+    /**
+        @brief Funzione che ritorna l'iteratore alla fine della sequenza dati.
+
+        @return iteratore alla fine della sequenza dati
+    */
+    const_iterator end(void) const {
+        return const_iterator(this, static_cast<std::ptrdiff_t>(_slots.size()));
+    }
+
+    /**
+        @brief Funzione GLOBALE che implementa l'operatore di stream,
+        con lo stesso formato del set di string. Le chiavi vengono copiate
+        dall'arena direttamente nel buffer di output.
+
+        @param os stream di output
+        @param ol set da spedire sullo stream
+
+        @return lo stream di output
+    */
+    friend std::ostream& operator<<(std::ostream &os, const string_set &ol) {
+        if (!output_buffer::default_format(os)) {
+            os << ol.size();
+            for (size_type i = 0; i < ol.size(); ++i)
+                os << " (" << ol[i] << ")";
+            return os;
+        }
+
+        output_buffer out(os);
+        out.write_value(ol.size());
+        for (size_type i = 0; i < ol.size(); ++i) {
+            const std::string_view key = ol[i];
+            out.write(" (", 2);
+            out.write(key.data(), key.size());
+            out.write(")", 1);
+        }
+        out.flush();
+        return os;
+    }
+};
+
+/**
+    @brief Funzione GLOBALE che scrive su un file passato
+    come stringa il string_set, nello stesso formato di save
+    per il set di string
+
+    @param set set da scrivere su un file
+    @param file file su cui scrivere
+
+    @throw possibile eccezione dalla scrittura su file
+*/
+inline void save(const string_set &set, const std::string &file) {
+    std::ofstream FILE;
+
+    try {
+        FILE.open(file);
+        FILE << set;
+        FILE.close();
+    } catch(...) {
+        if (FILE.is_open())
+            FILE.close();
+        throw;
+    }
+}
+
+#endif // STRING_SET_HPP